@@ -0,0 +1,85 @@
+#!/bin/bash
+
+# ==============================================================================
+# Adaptive Buffer Test Script
+#
+# Builds the IPC app once per workload with -DADAPTIVE_BUFFER (BUFFER_SIZE is
+# then only the preallocated maximum) and compares it against fixed buffer
+# sizes. For every adaptive run the capacity trajectory written by the
+# producer is kept, and the capacity it settled on is added to the CSV.
+# ==============================================================================
+
+# --- Configuration ---
+NUM_RUNS=20
+REST_INTERVAL_S=0.1
+PRODUCT_COUNTS=(10000 100000)
+MESSAGE_LENS=(64 1500 64000)
+MAX_BUFFER_SIZE=100
+FIXED_BUFFER_SIZES=(1 4 10 20 50 100)
+
+# --- Path Configuration ---
+SCRIPT_DIR="$( cd "$( dirname "${BASH_SOURCE[0]}" )" &> /dev/null && pwd )"
+PROJECT_ROOT_DIR="$(dirname "$SCRIPT_DIR")"
+IPC_SRC_DIR="${PROJECT_ROOT_DIR}/src/02_process_ipc_app"
+IPC_PRODUCER_EXE="${IPC_SRC_DIR}/producer"
+IPC_CONSUMER_EXE="${IPC_SRC_DIR}/consumer"
+IPC_RUN_SCRIPT="${IPC_SRC_DIR}/run_ipc_test.sh"
+
+RESULTS_DIR="${SCRIPT_DIR}/adaptive_buffer_results"
+OUTPUT_FILE="${RESULTS_DIR}/adaptive_buffer.csv"
+mkdir -p "$RESULTS_DIR"
+
+cleanup() {
+    (cd "$IPC_SRC_DIR" && make clean) > /dev/null 2>&1
+}
+trap cleanup EXIT
+
+# run_case <label> <product count> <message len> <make CFLAGS...>
+run_case() {
+    local label=$1 pcount=$2 mlen=$3
+    shift 3
+    (cd "$IPC_SRC_DIR" && make clean && make CFLAGS+="$*") > /dev/null 2>&1
+    if [ ! -f "$IPC_PRODUCER_EXE" ] || [ ! -f "$IPC_CONSUMER_EXE" ]; then
+        echo "    !! IPC compilation failed (${label})"; return
+    fi
+
+    local total_comm=0 total_cap=0
+    for j in $(seq 1 ${NUM_RUNS}); do
+        echo -ne "       - ${label} run ${j}/${NUM_RUNS}...\r"
+        sleep ${REST_INTERVAL_S}
+        # the producer writes its trajectory into the current directory.
+        result=$(cd "$RESULTS_DIR" && "$IPC_RUN_SCRIPT" | grep '^[0-9\.]\+,[0-9\.]\+')
+        comm_time=$(echo "$result" | cut -d',' -f2)
+        total_comm=$(awk -v t1="$total_comm" -v t2="$comm_time" 'BEGIN{print t1+t2}')
+
+        if [ "$label" = adaptive ] && [ -f "${RESULTS_DIR}/capacity_trajectory.csv" ]; then
+            settled=$(tail -n 1 "${RESULTS_DIR}/capacity_trajectory.csv" | cut -d',' -f4)
+            total_cap=$(( total_cap + ${settled:-0} ))
+            mv "${RESULTS_DIR}/capacity_trajectory.csv" "${RESULTS_DIR}/trajectory_P${pcount}_M${mlen}_run${j}.csv"
+        fi
+    done
+    echo ""
+
+    awk -v l="$label" -v p="$pcount" -v m="$mlen" -v n="$NUM_RUNS" -v comm="$total_comm" -v cap="$total_cap" \
+        'BEGIN{printf "%s,%s,%s,%.9f,%.1f\n", l, p, m, comm/n, (l == "adaptive" ? cap/n : 0)}' >> "$OUTPUT_FILE"
+}
+
+
+# --- MAIN EXECUTION ---
+echo "Mode,ProductCount,MessageLen,AvgCommTime,AvgSettledCapacity" > "$OUTPUT_FILE"
+
+for pcount in "${PRODUCT_COUNTS[@]}"; do
+    for mlen in "${MESSAGE_LENS[@]}"; do
+        echo "----------------------------------------------------"
+        echo ">> ProductCount=${pcount}, MessageLen=${mlen}"
+        BASE_FLAGS="-DNUM_PRODUCTS=${pcount} -DMAX_MESSAGE_LEN=${mlen}"
+
+        run_case adaptive "$pcount" "$mlen" ${BASE_FLAGS} -DADAPTIVE_BUFFER -DBUFFER_SIZE=${MAX_BUFFER_SIZE}
+        for bsize in "${FIXED_BUFFER_SIZES[@]}"; do
+            run_case "fixed_${bsize}" "$pcount" "$mlen" ${BASE_FLAGS} -DBUFFER_SIZE=${bsize}
+        done
+    done
+done
+
+echo "----------------------------------------------------"
+echo ">> Complete. Results are in ${OUTPUT_FILE}, trajectories in ${RESULTS_DIR}"
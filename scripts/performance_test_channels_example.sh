@@ -0,0 +1,64 @@
+#!/bin/bash
+
+# ==============================================================================
+# Multiplexed Channel Test Script (wait-any over many channels)
+#
+# Runs src/04_scaling_bench/channel_bench with one consumer serving a growing
+# number of channels of one channel table, sleeping on them with
+# futex_waitv() or with the shared doorbell futex, and writes the wakeup
+# latency (ns) and the consumer's CPU cost per message, each averaged over
+# NUM_RUNS runs. Producers are paced at TARGET_RATE messages/s each, low
+# enough that the consumer sleeps between messages.
+# ==============================================================================
+
+# --- Configuration ---
+NUM_RUNS=5
+MESSAGE_COUNT=20000
+TARGET_RATE=10000
+BUFFER_SIZE=64
+MESSAGE_LEN=64
+PRODUCERS=1
+CHANNEL_COUNTS=(1 8 64 128 129 512 1024 4096 16384)
+MODELS=("thread" "process")
+WAITS=("waitv" "doorbell")
+
+# --- Path Configuration ---
+SCRIPT_DIR="$( cd "$( dirname "${BASH_SOURCE[0]}" )" &> /dev/null && pwd )"
+PROJECT_ROOT_DIR="$(dirname "$SCRIPT_DIR")"
+BENCH_SRC_DIR="${PROJECT_ROOT_DIR}/src/04_scaling_bench"
+CHANNEL_EXE="${BENCH_SRC_DIR}/channel_bench"
+
+OUTPUT_FILE="channels_results.csv"
+
+cleanup() {
+    (cd "$BENCH_SRC_DIR" && make clean) > /dev/null 2>&1
+}
+trap cleanup EXIT
+
+
+# --- MAIN EXECUTION ---
+(cd "$BENCH_SRC_DIR" && make clean && make CFLAGS+="-O2 -DBUFFER_SIZE=${BUFFER_SIZE} -DMAX_MESSAGE_LEN=${MESSAGE_LEN} -DTARGET_RATE=${TARGET_RATE}") > /dev/null 2>&1
+if [ ! -f "$CHANNEL_EXE" ]; then
+    echo "!! channel_bench compilation failed"
+    exit 1
+fi
+
+echo "Model,Wait,Channels,Producers,Messages,ElapsedS,MsgsPerSec,SleepsPerMsg,ConsumerCpuUsPerMsg,LatMean,LatP50,LatP90,LatP99,LatP999,LatMax" > "$OUTPUT_FILE"
+
+for model in "${MODELS[@]}"; do
+    for wait in "${WAITS[@]}"; do
+        echo "----------------------------------------------------"
+        echo ">> ${model} / ${wait}"
+        for channels in "${CHANNEL_COUNTS[@]}"; do
+            echo "   - channels=${channels}: ${NUM_RUNS} runs..."
+            for j in $(seq 1 ${NUM_RUNS}); do
+                "$CHANNEL_EXE" -m "$model" -w "$wait" -c "$channels" -p "$PRODUCERS" -n "$MESSAGE_COUNT"
+            done | awk -F',' 'NF==15 {n++; for(k=6;k<=15;k++) s[k]+=$k; head=$1","$2","$3","$4","$5}
+                END{if(n){printf "%s,%.9f,%.0f,%.4f,%.3f", head, s[6]/n, s[7]/n, s[8]/n, s[9]/n; for(k=10;k<=15;k++) printf ",%.0f", s[k]/n; printf "\n"}}' \
+                >> "$OUTPUT_FILE"
+        done
+    done
+done
+
+echo "----------------------------------------------------"
+echo ">> Complete. Results are in ${OUTPUT_FILE}"
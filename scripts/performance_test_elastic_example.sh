@@ -0,0 +1,74 @@
+#!/bin/bash
+
+# ==============================================================================
+# Elastic Consumer Pool Test Script (bursty load, fixed vs elastic pools)
+#
+# Runs src/04_scaling_bench/elastic_bench under a bursty open-loop load with
+# a fixed small pool, a fixed large pool and an elastic pool that scales
+# between the two, and writes latency (ns), scale events and the average
+# number of consumers (the cost) per pool, averaged over NUM_RUNS runs.
+# The first run of every pool also writes its timeline (backlog, consumers
+# and per-tick latency) to TIMELINE_FILE.
+# ==============================================================================
+
+# --- Configuration ---
+NUM_RUNS=3
+DURATION_S=6
+RATES="5000,50000"          # base,burst messages/s
+BURSTS="500,2000"           # burst_ms,period_ms
+TICK_MS=10
+WORKLOAD="spin:20000"       # per-message consumer work
+POOLS=("1,1" "8,8" "1,8")   # min,max consumers
+BACKENDS=("sem" "eventfd")
+BUFFER_SIZE=256
+MESSAGE_LEN=64
+
+# --- Path Configuration ---
+SCRIPT_DIR="$( cd "$( dirname "${BASH_SOURCE[0]}" )" &> /dev/null && pwd )"
+PROJECT_ROOT_DIR="$(dirname "$SCRIPT_DIR")"
+BENCH_SRC_DIR="${PROJECT_ROOT_DIR}/src/04_scaling_bench"
+ELASTIC_EXE="${BENCH_SRC_DIR}/elastic_bench"
+
+OUTPUT_FILE="elastic_results.csv"
+TIMELINE_FILE="elastic_timeline.csv"
+
+cleanup() {
+    (cd "$BENCH_SRC_DIR" && make clean) > /dev/null 2>&1
+}
+trap cleanup EXIT
+
+
+# --- MAIN EXECUTION ---
+(cd "$BENCH_SRC_DIR" && make clean && make CFLAGS+="-O2 -DBUFFER_SIZE=${BUFFER_SIZE} -DMAX_MESSAGE_LEN=${MESSAGE_LEN}") > /dev/null 2>&1
+if [ ! -f "$ELASTIC_EXE" ]; then
+    echo "!! elastic_bench compilation failed"
+    exit 1
+fi
+export WORKLOAD
+
+echo "Backend,MinConsumers,MaxConsumers,Messages,ElapsedS,ScaleUps,ScaleDowns,AvgConsumers,MaxBacklog,LatMean,LatP50,LatP90,LatP99,LatP999,LatMax" > "$OUTPUT_FILE"
+echo "Backend,Pool,Event,TimeMs,Consumers,Backlog,Messages,LatMean,LatP50,LatP99" > "$TIMELINE_FILE"
+
+for backend in "${BACKENDS[@]}"; do
+    echo "----------------------------------------------------"
+    echo ">> ${backend}"
+    for pool in "${POOLS[@]}"; do
+        echo "   - pool ${pool}: ${NUM_RUNS} runs..."
+        for j in $(seq 1 ${NUM_RUNS}); do
+            if [ "$j" -eq 1 ]; then
+                "$ELASTIC_EXE" -b "$backend" -k "$pool" -d "$DURATION_S" -r "$RATES" -B "$BURSTS" -t "$TICK_MS" -v
+            else
+                "$ELASTIC_EXE" -b "$backend" -k "$pool" -d "$DURATION_S" -r "$RATES" -B "$BURSTS" -t "$TICK_MS"
+            fi
+        done | awk -F',' -v b="$backend" -v p="${pool/,/-}" -v timeline="$TIMELINE_FILE" \
+            '$1=="tick"  {printf "%s,%s,tick,%s,%s,%s,%s,%s,%s,%s\n", b, p, $2, $3, $4, $5, $6, $7, $8 >> timeline; next}
+             $1=="scale" {printf "%s,%s,%s,%s,%s,%s,,,,\n", b, p, $3, $2, $4, $5 >> timeline; next}
+             NF==15 {n++; for(k=4;k<=15;k++) s[k]+=$k; head=$1","$2","$3}
+             END{if(n){printf "%s,%.0f,%.9f,%.1f,%.1f,%.3f,%.0f", head, s[4]/n, s[5]/n, s[6]/n, s[7]/n, s[8]/n, s[9]/n;
+                 for(k=10;k<=15;k++) printf ",%.0f", s[k]/n; printf "\n"}}' \
+            >> "$OUTPUT_FILE"
+    done
+done
+
+echo "----------------------------------------------------"
+echo ">> Complete. Results are in ${OUTPUT_FILE} and ${TIMELINE_FILE}"
@@ -0,0 +1,83 @@
+#!/bin/bash
+
+# ==============================================================================
+# eventfd Notification Test Script (eventfd/epoll vs semaphores)
+#
+# Runs src/04_scaling_bench/rpc_bench for the "eventfd" backend (ring in
+# shared memory, notifications through coalesced eventfds waited on with
+# epoll) and the "sem" backend, and reports the round-trip latency (ns)
+# averaged over NUM_RUNS runs plus the syscalls per RPC, counted by one
+# extra run under `strace -f -c` (strace slows that run down, so it is not
+# part of the latency numbers).
+#
+# If `strace` is unavailable the syscall column stays 0.
+# ==============================================================================
+
+# --- Configuration ---
+NUM_RUNS=5
+RPC_COUNT=200000
+BUFFER_SIZE=64
+MESSAGE_LEN=64
+OUTSTANDING=(1 4 16 64)
+MODELS=("thread" "process")
+BACKENDS=("sem" "eventfd")
+
+# --- Path Configuration ---
+SCRIPT_DIR="$( cd "$( dirname "${BASH_SOURCE[0]}" )" &> /dev/null && pwd )"
+PROJECT_ROOT_DIR="$(dirname "$SCRIPT_DIR")"
+BENCH_SRC_DIR="${PROJECT_ROOT_DIR}/src/04_scaling_bench"
+RPC_EXE="${BENCH_SRC_DIR}/rpc_bench"
+STAT_FILE="${SCRIPT_DIR}/eventfd_strace.tmp"
+
+OUTPUT_FILE="eventfd_results.csv"
+
+STRACE_AVAILABLE=true
+if ! strace -f -c -o /dev/null true > /dev/null 2>&1; then
+    echo "!! WARNING: 'strace' is not usable here, the syscall column will be 0."
+    STRACE_AVAILABLE=false
+fi
+
+cleanup() {
+    rm -f "$STAT_FILE"
+    (cd "$BENCH_SRC_DIR" && make clean) > /dev/null 2>&1
+}
+trap cleanup EXIT
+
+# count_syscalls <strace -c file>: sum of the per-syscall "calls" column.
+count_syscalls() {
+    awk '$1 ~ /^[0-9.]+$/ && $NF != "total" && NF >= 5 {s+=$4} END{print s+0}' "$1"
+}
+
+
+# --- MAIN EXECUTION ---
+(cd "$BENCH_SRC_DIR" && make clean && make CFLAGS+="-O2 -DBUFFER_SIZE=${BUFFER_SIZE} -DMAX_MESSAGE_LEN=${MESSAGE_LEN}") > /dev/null 2>&1
+if [ ! -f "$RPC_EXE" ]; then
+    echo "!! rpc_bench compilation failed"
+    exit 1
+fi
+
+echo "Model,Backend,Outstanding,Rpcs,ElapsedS,RpcsPerSec,BlocksPerRpc,RttMean,RttP50,RttP90,RttP99,RttP999,RttMax,SyscallsPerRpc" > "$OUTPUT_FILE"
+
+for model in "${MODELS[@]}"; do
+    for backend in "${BACKENDS[@]}"; do
+        echo "----------------------------------------------------"
+        echo ">> ${model} / ${backend}"
+        for window in "${OUTSTANDING[@]}"; do
+            echo "   - outstanding=${window}: ${NUM_RUNS} runs..."
+            syscalls=0
+            if [ "$STRACE_AVAILABLE" = true ]; then
+                strace -f -c -o "$STAT_FILE" "$RPC_EXE" -m "$model" -b "$backend" -n "$RPC_COUNT" -o "$window" > /dev/null
+                syscalls=$(count_syscalls "$STAT_FILE")
+            fi
+            for j in $(seq 1 ${NUM_RUNS}); do
+                "$RPC_EXE" -m "$model" -b "$backend" -n "$RPC_COUNT" -o "$window"
+            done | awk -F',' -v sc="$syscalls" -v r="$RPC_COUNT" \
+                'NF==13 {n++; for(k=5;k<=13;k++) s[k]+=$k; head=$1","$2","$3","$4}
+                END{if(n){printf "%s,%.9f,%.0f,%.4f", head, s[5]/n, s[6]/n, s[7]/n; for(k=8;k<=13;k++) printf ",%.0f", s[k]/n; printf ",%.3f\n", sc/r}}' \
+                >> "$OUTPUT_FILE"
+        done
+    done
+done
+
+echo "----------------------------------------------------"
+echo ">> Complete. Results are in ${OUTPUT_FILE}"
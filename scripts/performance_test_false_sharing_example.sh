@@ -0,0 +1,141 @@
+#!/bin/bash
+
+# ==============================================================================
+# False Sharing Test Script (packed vs padded shared_data layout)
+#
+# Builds every model twice -- once with the original packed layout and once
+# with -DPADDED_LAYOUT (hot fields and slots on their own cache lines) -- and
+# reports communication time together with cache-miss and HITM counts, so the
+# false-sharing penalty on this machine can be read straight off the CSV.
+#
+# HITM (load hit a Modified line in another core's cache) comes from
+# `perf c2c`, which needs root and a CPU with load-latency sampling
+# (Intel PEBS / AMD IBS). If `perf c2c` is unavailable the HITM columns stay 0.
+# ==============================================================================
+
+# --- Configuration ---
+NUM_RUNS=10
+REST_INTERVAL_S=0.1
+PRODUCT_COUNT=100000
+BUFFER_SIZES=(1 4 16 64)
+MESSAGE_LENS=(8 64 256 1024)
+CACHE_LINE_SIZES=(64 128)
+PERF_EVENTS="cache-references,cache-misses,L1-dcache-load-misses"
+
+# --- Path Configuration ---
+SCRIPT_DIR="$( cd "$( dirname "${BASH_SOURCE[0]}" )" &> /dev/null && pwd )"
+PROJECT_ROOT_DIR="$(dirname "$SCRIPT_DIR")"
+IPC_SRC_DIR="${PROJECT_ROOT_DIR}/src/02_process_ipc_app"
+IPC_PRODUCER_EXE="${IPC_SRC_DIR}/producer"
+IPC_CONSUMER_EXE="${IPC_SRC_DIR}/consumer"
+IPC_RUN_SCRIPT="${IPC_SRC_DIR}/run_ipc_test.sh"
+ITC_SRC_DIR="${PROJECT_ROOT_DIR}/src/03_thread_itc_app"
+ITC_SRC="${ITC_SRC_DIR}/thread_producer_consumer.c"
+ITC_EXE="${SCRIPT_DIR}/thread_false_sharing"
+
+RESULTS_DIR="${SCRIPT_DIR}/false_sharing_results"
+OUTPUT_FILE="${RESULTS_DIR}/false_sharing.csv"
+
+# --- Pre-run Checks ---
+if [[ $EUID -ne 0 ]]; then
+    echo "!! ERROR: This script requires root privileges (use sudo) to run 'perf'."
+    exit 1
+fi
+C2C_AVAILABLE=true
+if ! perf c2c record -o /dev/null -- true > /dev/null 2>&1; then
+    echo "!! WARNING: 'perf c2c' is not supported here, HITM columns will be 0."
+    C2C_AVAILABLE=false
+fi
+mkdir -p "$RESULTS_DIR"
+
+cleanup() {
+    rm -f "$ITC_EXE" "${RESULTS_DIR}"/*.data "${RESULTS_DIR}"/*.tmp
+    (cd "$IPC_SRC_DIR" && make clean) > /dev/null 2>&1
+}
+trap cleanup EXIT
+
+# --- FUNCTIONS ---
+
+# read_counter <perf stat -x, file> <event name>
+read_counter() {
+    awk -F',' -v ev="$2" '$3==ev{v=$1+0} END{print v+0}' "$1"
+}
+
+# read_hitm <perf c2c report file> <"Local"|"Remote">
+read_hitm() {
+    local v
+    v=$(grep -E "Load $2 HITM" "$1" | head -n 1 | awk -F':' '{gsub(/ /, "", $2); print $2}')
+    [[ "$v" =~ ^[0-9]+$ ]] && echo "$v" || echo 0
+}
+
+# measure <test type> <layout> <line size> <bsize> <mlen> <command...>
+measure() {
+    local type=$1 layout=$2 line=$3 bsize=$4 mlen=$5
+    shift 5
+    local total_comm=0 total_refs=0 total_miss=0 total_l1=0 total_lhitm=0 total_rhitm=0
+    local stat_file="${RESULTS_DIR}/stat.tmp"
+    local c2c_file="${RESULTS_DIR}/c2c.data"
+    local report_file="${RESULTS_DIR}/c2c.tmp"
+
+    for j in $(seq 1 ${NUM_RUNS}); do
+        echo -ne "       - ${type}/${layout}/${line}B run ${j}/${NUM_RUNS}...\r"
+        sleep ${REST_INTERVAL_S}
+
+        result=$(perf stat -x, -e "$PERF_EVENTS" -o "$stat_file" "$@" | grep '^[0-9\.]\+,[0-9\.]\+')
+        comm_time=$(echo "$result" | cut -d',' -f2)
+        total_comm=$(awk -v t1="$total_comm" -v t2="$comm_time" 'BEGIN{print t1+t2}')
+        total_refs=$(( total_refs + $(read_counter "$stat_file" cache-references) ))
+        total_miss=$(( total_miss + $(read_counter "$stat_file" cache-misses) ))
+        total_l1=$(( total_l1 + $(read_counter "$stat_file" L1-dcache-load-misses) ))
+
+        if [ "$C2C_AVAILABLE" = true ]; then
+            perf c2c record -o "$c2c_file" -- "$@" > /dev/null 2>&1
+            perf c2c report -i "$c2c_file" --stdio > "$report_file" 2>/dev/null
+            total_lhitm=$(( total_lhitm + $(read_hitm "$report_file" Local) ))
+            total_rhitm=$(( total_rhitm + $(read_hitm "$report_file" Remote) ))
+        fi
+    done
+    echo ""
+
+    awk -v type="$type" -v layout="$layout" -v line="$line" -v b="$bsize" -v m="$mlen" -v n="$NUM_RUNS" \
+        -v comm="$total_comm" -v refs="$total_refs" -v miss="$total_miss" -v l1="$total_l1" \
+        -v lh="$total_lhitm" -v rh="$total_rhitm" \
+        'BEGIN{printf "%s,%s,%s,%s,%s,%.9f,%d,%d,%d,%d,%d\n", type, layout, line, b, m, comm/n, refs/n, miss/n, l1/n, lh/n, rh/n}' \
+        >> "$OUTPUT_FILE"
+}
+
+
+# --- MAIN EXECUTION ---
+echo "TestType,Layout,CacheLineSize,BufferSize,MessageLen,AvgCommTime,AvgCacheRefs,AvgCacheMisses,AvgL1DMisses,AvgLocalHITM,AvgRemoteHITM" > "$OUTPUT_FILE"
+
+for bsize in "${BUFFER_SIZES[@]}"; do
+    for mlen in "${MESSAGE_LENS[@]}"; do
+        echo "----------------------------------------------------"
+        echo ">> BufferSize=${bsize}, MessageLen=${mlen}"
+
+        for line in "${CACHE_LINE_SIZES[@]}"; do
+            for layout in packed padded; do
+                # The packed layout does not depend on the line size, measure it once.
+                if [ "$layout" = packed ] && [ "$line" != "${CACHE_LINE_SIZES[0]}" ]; then
+                    continue
+                fi
+                LAYOUT_FLAGS="-DCACHE_LINE_SIZE=${line}"
+                [ "$layout" = padded ] && LAYOUT_FLAGS+=" -DPADDED_LAYOUT"
+                BUILD_FLAGS="-DNUM_PRODUCTS=${PRODUCT_COUNT} -DBUFFER_SIZE=${bsize} -DMAX_MESSAGE_LEN=${mlen} ${LAYOUT_FLAGS}"
+
+                gcc "$ITC_SRC" -o "$ITC_EXE" ${BUILD_FLAGS} -lpthread -lrt
+                if [ $? -ne 0 ]; then echo "    !! ITC compilation failed"; continue; fi
+                measure "ITC" "$layout" "$line" "$bsize" "$mlen" "$ITC_EXE"
+
+                (cd "$IPC_SRC_DIR" && make clean && make CFLAGS+="${BUILD_FLAGS}") > /dev/null 2>&1
+                if [ ! -f "$IPC_PRODUCER_EXE" ] || [ ! -f "$IPC_CONSUMER_EXE" ]; then
+                    echo "    !! IPC compilation failed"; continue
+                fi
+                measure "IPC" "$layout" "$line" "$bsize" "$mlen" "$IPC_RUN_SCRIPT"
+            done
+        done
+    done
+done
+
+echo "----------------------------------------------------"
+echo ">> Complete. Results are in ${OUTPUT_FILE}"
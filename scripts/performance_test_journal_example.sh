@@ -0,0 +1,94 @@
+#!/bin/bash
+
+# ==============================================================================
+# Journal Durability Test Script (-DJOURNAL sync policies)
+#
+# Builds the IPC app without a journal (baseline) and with the file-backed
+# journal under every durability policy and sync interval, and reports the
+# producer-to-consumer throughput of each, plus how fast ./replay reads the
+# finished journal back from the start.
+#
+# The journal lives in JOURNAL_DIR; point it at the file system whose
+# durability you care about (tmpfs turns every sync into a no-op).
+# ==============================================================================
+
+# --- Configuration ---
+NUM_RUNS=5
+PRODUCT_COUNT=200000
+BUFFER_SIZE=64
+MESSAGE_LENS=(64 1024)
+POLICIES=("none" "msync" "fdatasync")
+SYNC_INTERVALS=(1 64 4096)
+
+# --- Path Configuration ---
+SCRIPT_DIR="$( cd "$( dirname "${BASH_SOURCE[0]}" )" &> /dev/null && pwd )"
+PROJECT_ROOT_DIR="$(dirname "$SCRIPT_DIR")"
+IPC_SRC_DIR="${PROJECT_ROOT_DIR}/src/02_process_ipc_app"
+IPC_RUN_SCRIPT="${IPC_SRC_DIR}/run_ipc_test.sh"
+IPC_PRODUCER_EXE="${IPC_SRC_DIR}/producer"
+IPC_REPLAY_EXE="${IPC_SRC_DIR}/replay"
+JOURNAL_DIR="${SCRIPT_DIR}/journal_data"
+export IPC_JOURNAL="${JOURNAL_DIR}/ipc_journal"
+
+OUTPUT_FILE="journal_results.csv"
+
+mkdir -p "$JOURNAL_DIR"
+cleanup() {
+    rm -rf "$JOURNAL_DIR"
+    (cd "$IPC_SRC_DIR" && make clean) > /dev/null 2>&1
+}
+trap cleanup EXIT
+
+# measure <policy> <interval> <mlen> <extra build flags>
+measure() {
+    local policy=$1 interval=$2 mlen=$3 flags=$4
+    (cd "$IPC_SRC_DIR" && make clean && make CFLAGS+="-O2 -DNUM_PRODUCTS=${PRODUCT_COUNT} -DBUFFER_SIZE=${BUFFER_SIZE} -DMAX_MESSAGE_LEN=${mlen} ${flags}") > /dev/null 2>&1
+    if [ ! -f "$IPC_PRODUCER_EXE" ]; then
+        echo "    !! IPC compilation failed"; return
+    fi
+
+    echo "   - ${policy}/${interval}: ${NUM_RUNS} runs..."
+    local total_comm=0 total_replay=0 replays=0
+    for j in $(seq 1 ${NUM_RUNS}); do
+        comm_time=$("$IPC_RUN_SCRIPT" | grep '^[0-9\.]\+,[0-9\.]\+' | cut -d',' -f2)
+        total_comm=$(awk -v t="$total_comm" -v c="$comm_time" 'BEGIN{print t+c}')
+        if [ "$policy" != "baseline" ]; then
+            # records,seconds,msgs_per_s,...
+            replay_rate=$("$IPC_REPLAY_EXE" | cut -d',' -f3)
+            total_replay=$(awk -v t="$total_replay" -v r="$replay_rate" 'BEGIN{print t+r}')
+            replays=$(( replays + 1 ))
+        fi
+    done
+
+    awk -v pol="$policy" -v iv="$interval" -v p="$PRODUCT_COUNT" -v b="$BUFFER_SIZE" -v m="$mlen" -v n="$NUM_RUNS" \
+        -v comm="$total_comm" -v replay="$total_replay" -v rn="$replays" \
+        'BEGIN{avg=comm/n; printf "%s,%s,%s,%s,%s,%.9f,%.0f,%.1f,%.0f\n", pol, iv, p, b, m, avg, p/avg, p*m/avg/1e6, rn ? replay/rn : 0}' \
+        >> "$OUTPUT_FILE"
+}
+
+
+# --- MAIN EXECUTION ---
+echo "Policy,SyncInterval,ProductCount,BufferSize,MessageLen,AvgCommTime,MsgsPerSec,PayloadMBps,ReplayMsgsPerSec" > "$OUTPUT_FILE"
+
+for mlen in "${MESSAGE_LENS[@]}"; do
+    echo "----------------------------------------------------"
+    echo ">> MessageLen=${mlen}"
+    measure "baseline" 0 "$mlen" ""
+    for policy in "${POLICIES[@]}"; do
+        case "$policy" in
+            none)      policy_flag="JOURNAL_SYNC_NONE" ;;
+            msync)     policy_flag="JOURNAL_SYNC_MSYNC" ;;
+            fdatasync) policy_flag="JOURNAL_SYNC_FDATASYNC" ;;
+        esac
+        for interval in "${SYNC_INTERVALS[@]}"; do
+            # the interval means nothing without syncing, measure "none" once.
+            if [ "$policy" = "none" ] && [ "$interval" != "${SYNC_INTERVALS[0]}" ]; then
+                continue
+            fi
+            measure "$policy" "$interval" "$mlen" "-DJOURNAL -DJOURNAL_SYNC_POLICY=${policy_flag} -DJOURNAL_SYNC_INTERVAL=${interval}"
+        done
+    done
+done
+
+echo "----------------------------------------------------"
+echo ">> Complete. Results are in ${OUTPUT_FILE}"
@@ -0,0 +1,64 @@
+#!/bin/bash
+
+# ==============================================================================
+# Priority Lane Test Script (urgent messages vs bulk traffic)
+#
+# Runs src/04_scaling_bench/lanes_bench under mixed load (paced high and
+# normal lanes, a saturated bulk lane) with the priority policy and with
+# the one-FIFO baseline, for every bulk message size in BULK_LENS, and
+# writes each lane's latency percentiles (ns), averaged over NUM_RUNS runs.
+# ==============================================================================
+
+# --- Configuration ---
+NUM_RUNS=5
+DURATION_S=2
+RATES="1000,5000,0"         # high,normal,bulk messages/s (0 = saturate)
+BULK_LENS=(4096 16384 65536)
+NORMAL_STARVE=8
+BULK_STARVE=32
+MODELS=("thread" "process")
+POLICIES=("fifo" "priority")
+
+# --- Path Configuration ---
+SCRIPT_DIR="$( cd "$( dirname "${BASH_SOURCE[0]}" )" &> /dev/null && pwd )"
+PROJECT_ROOT_DIR="$(dirname "$SCRIPT_DIR")"
+BENCH_SRC_DIR="${PROJECT_ROOT_DIR}/src/04_scaling_bench"
+LANES_EXE="${BENCH_SRC_DIR}/lanes_bench"
+
+OUTPUT_FILE="lanes_results.csv"
+
+cleanup() {
+    (cd "$BENCH_SRC_DIR" && make clean) > /dev/null 2>&1
+}
+trap cleanup EXIT
+
+
+# --- MAIN EXECUTION ---
+echo "BulkLen,Model,Policy,Lane,MessageLen,Messages,MsgsPerSec,BlocksPerMsg,LatMean,LatP50,LatP90,LatP99,LatP999,LatMax" > "$OUTPUT_FILE"
+
+for bulk_len in "${BULK_LENS[@]}"; do
+    (cd "$BENCH_SRC_DIR" && make clean && make CFLAGS+="-O2 -DLANE_BULK_LEN=${bulk_len} -DLANE_NORMAL_STARVE=${NORMAL_STARVE} -DLANE_BULK_STARVE=${BULK_STARVE}") > /dev/null 2>&1
+    if [ ! -f "$LANES_EXE" ]; then
+        echo "!! lanes_bench compilation failed"
+        exit 1
+    fi
+
+    for model in "${MODELS[@]}"; do
+        echo "----------------------------------------------------"
+        echo ">> BulkLen=${bulk_len} / ${model}"
+        for policy in "${POLICIES[@]}"; do
+            echo "   - ${policy}: ${NUM_RUNS} runs..."
+            for j in $(seq 1 ${NUM_RUNS}); do
+                "$LANES_EXE" -m "$model" -P "$policy" -d "$DURATION_S" -r "$RATES"
+            done | awk -F',' -v b="$bulk_len" -v m="$model" \
+                'NF==12 {key=$1","$2","$3; if(!(key in n)) order[++lanes]=key; n[key]++; for(k=4;k<=12;k++) s[key,k]+=$k}
+                END{for(l=1;l<=lanes;l++){key=order[l]; c=n[key];
+                    printf "%s,%s,%s,%.0f,%.0f,%.4f", b, m, key, s[key,4]/c, s[key,5]/c, s[key,6]/c;
+                    for(k=7;k<=12;k++) printf ",%.0f", s[key,k]/c; printf "\n"}}' \
+                >> "$OUTPUT_FILE"
+        done
+    done
+done
+
+echo "----------------------------------------------------"
+echo ">> Complete. Results are in ${OUTPUT_FILE}"
@@ -0,0 +1,85 @@
+#!/bin/bash
+
+# ==============================================================================
+# Live Stats Overhead Test Script (-DLIVE_STATS + ./monitor)
+#
+# Builds the IPC app without live stats (baseline) and with -DLIVE_STATS,
+# and runs the latter twice: on its own, and with ./monitor attached and
+# sampling every MONITOR_INTERVAL_MS. The three throughputs show what
+# publishing the counters costs and that a reader does not slow the
+# channel down. What the monitor saw goes to MONITOR_FILE.
+# ==============================================================================
+
+# --- Configuration ---
+NUM_RUNS=5
+PRODUCT_COUNT=500000
+BUFFER_SIZE=64
+MESSAGE_LENS=(64 1024)
+MONITOR_INTERVAL_MS=100
+
+# --- Path Configuration ---
+SCRIPT_DIR="$( cd "$( dirname "${BASH_SOURCE[0]}" )" &> /dev/null && pwd )"
+PROJECT_ROOT_DIR="$(dirname "$SCRIPT_DIR")"
+IPC_SRC_DIR="${PROJECT_ROOT_DIR}/src/02_process_ipc_app"
+IPC_RUN_SCRIPT="${IPC_SRC_DIR}/run_ipc_test.sh"
+IPC_PRODUCER_EXE="${IPC_SRC_DIR}/producer"
+IPC_MONITOR_EXE="${IPC_SRC_DIR}/monitor"
+export IPC_CHANNEL="live_stats_test"
+
+OUTPUT_FILE="live_stats_results.csv"
+MONITOR_FILE="live_stats_monitor.csv"
+MONITOR_TMP="$(mktemp)"
+
+MONITOR_PID=""
+cleanup() {
+    [ -n "$MONITOR_PID" ] && kill "$MONITOR_PID" 2> /dev/null
+    rm -f "$MONITOR_TMP"
+    (cd "$IPC_SRC_DIR" && make clean) > /dev/null 2>&1
+}
+trap cleanup EXIT
+
+# measure <mode> <mlen> <extra build flags>
+measure() {
+    local mode=$1 mlen=$2 flags=$3
+    (cd "$IPC_SRC_DIR" && make clean && make CFLAGS+="-O2 -DNUM_PRODUCTS=${PRODUCT_COUNT} -DBUFFER_SIZE=${BUFFER_SIZE} -DMAX_MESSAGE_LEN=${mlen} ${flags}") > /dev/null 2>&1
+    if [ ! -f "$IPC_PRODUCER_EXE" ]; then
+        echo "    !! IPC compilation failed"; return
+    fi
+
+    echo "   - ${mode}: ${NUM_RUNS} runs..."
+    if [ "$mode" = "monitored" ]; then
+        "$IPC_MONITOR_EXE" -b -i "$MONITOR_INTERVAL_MS" "$IPC_CHANNEL" > "$MONITOR_TMP" &
+        MONITOR_PID=$!
+    fi
+
+    local total_comm=0
+    for j in $(seq 1 ${NUM_RUNS}); do
+        comm_time=$("$IPC_RUN_SCRIPT" | grep '^[0-9\.]\+,[0-9\.]\+' | cut -d',' -f2)
+        total_comm=$(awk -v t="$total_comm" -v c="$comm_time" 'BEGIN{print t+c}')
+    done
+
+    if [ -n "$MONITOR_PID" ]; then
+        kill "$MONITOR_PID"; wait "$MONITOR_PID" 2> /dev/null
+        MONITOR_PID=""
+        tail -n +2 "$MONITOR_TMP" | sed "s/^/${mlen},/" >> "$MONITOR_FILE"
+    fi
+
+    awk -v mode="$mode" -v p="$PRODUCT_COUNT" -v b="$BUFFER_SIZE" -v m="$mlen" -v n="$NUM_RUNS" -v comm="$total_comm" \
+        'BEGIN{avg=comm/n; printf "%s,%s,%s,%s,%.9f,%.0f\n", mode, p, b, m, avg, p/avg}' >> "$OUTPUT_FILE"
+}
+
+
+# --- MAIN EXECUTION ---
+echo "Mode,ProductCount,BufferSize,MessageLen,AvgCommTime,MsgsPerSec" > "$OUTPUT_FILE"
+echo "MessageLen,Elapsed_s,Channel,MsgsPerSec,MBps,ProducerBlocksPerSec,ConsumerBlocksPerSec,Occupancy,Capacity,LatencyP50,LatencyP99,LatencyP99.9" > "$MONITOR_FILE"
+
+for mlen in "${MESSAGE_LENS[@]}"; do
+    echo "----------------------------------------------------"
+    echo ">> MessageLen=${mlen}"
+    measure "baseline" "$mlen" ""
+    measure "live_stats" "$mlen" "-DLIVE_STATS"
+    measure "monitored" "$mlen" "-DLIVE_STATS"
+done
+
+echo "----------------------------------------------------"
+echo ">> Complete. Results are in ${OUTPUT_FILE}, monitor samples in ${MONITOR_FILE}"
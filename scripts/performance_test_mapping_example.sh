@@ -0,0 +1,52 @@
+#!/bin/bash
+
+# ==============================================================================
+# Shared-Memory Mapping Test Script (01_shared_memory_basics/mapping_bench.c)
+#
+# Measures what getting a shared segment ready costs, phase by phase
+# (create, size, map, first touch, unmap), for shm_open, memfd_create,
+# anonymous MAP_SHARED, MAP_POPULATE, THP and hugetlb segments from
+# MIN_SIZE to MAX_SIZE, with the page faults taken and ns per page.
+# This is the setup the IPC app's initialize_time is made of.
+#
+# thp needs /sys/kernel/mm/transparent_hugepage/shmem_enabled set to
+# advise (or always) and only has rows from 2 MB up; hugetlb needs
+# reserved pages, e.g.
+#   sudo sysctl vm.nr_hugepages=600
+# Without them the bench says so on stderr and leaves the rows out.
+# ==============================================================================
+
+# --- Configuration ---
+ITERATIONS=5
+MIN_SIZE="4K"
+MAX_SIZE="1G"
+SIZE_FACTOR=4
+STRATEGIES="shm,memfd,anon,populate,thp,hugetlb"
+
+# --- Path Configuration ---
+SCRIPT_DIR="$( cd "$( dirname "${BASH_SOURCE[0]}" )" &> /dev/null && pwd )"
+PROJECT_ROOT_DIR="$(dirname "$SCRIPT_DIR")"
+BASICS_SRC_DIR="${PROJECT_ROOT_DIR}/src/01_shared_memory_basics"
+MAPPING_EXE="${BASICS_SRC_DIR}/mapping_bench"
+
+OUTPUT_FILE="mapping_results.csv"
+
+cleanup() {
+    rm -f "$MAPPING_EXE"
+}
+trap cleanup EXIT
+
+
+# --- MAIN EXECUTION ---
+if ! gcc -O2 -Wall -Wextra -o "$MAPPING_EXE" "${BASICS_SRC_DIR}/mapping_bench.c" -lrt; then
+    echo "!! mapping_bench compilation failed"; exit 1
+fi
+
+echo "Strategy,SizeBytes,Pages,Create_ns,Size_ns,Map_ns,Touch_ns,Unmap_ns,Total_ns,Faults,TouchNsPerPage,TotalNsPerPage,FirstTouchMBps,WriteMBps" > "$OUTPUT_FILE"
+
+echo "----------------------------------------------------"
+echo ">> ${STRATEGIES}: ${MIN_SIZE}..${MAX_SIZE} (x${SIZE_FACTOR}), ${ITERATIONS} iterations each"
+"$MAPPING_EXE" -s "$STRATEGIES" -z "$MIN_SIZE" -Z "$MAX_SIZE" -f "$SIZE_FACTOR" -n "$ITERATIONS" >> "$OUTPUT_FILE"
+
+echo "----------------------------------------------------"
+echo ">> Complete. Results are in ${OUTPUT_FILE}"
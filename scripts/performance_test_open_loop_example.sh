@@ -0,0 +1,109 @@
+#!/bin/bash
+
+# ==============================================================================
+# Latency vs Offered Load Test Script (open-loop producer)
+#
+# 1. Measures each transport's closed-loop saturation rate (messages/s).
+# 2. Rebuilds with -DOPEN_LOOP and offers LOAD_PERCENTS of that rate, with
+#    evenly spaced and with Poisson arrivals.
+# 3. Records the consumer's latency percentiles, measured from each message's
+#    intended send time, so queueing delay near saturation is not hidden.
+#
+# Every load point runs for about RUN_DURATION_S seconds. Plot P99 (or any
+# other column) against LoadPct per Transport/Arrival to get the curve.
+# ==============================================================================
+
+# --- Configuration ---
+NUM_RUNS=3
+SATURATION_RUNS=5
+REST_INTERVAL_S=0.1
+SATURATION_PRODUCTS=200000
+RUN_DURATION_S=1
+MIN_PRODUCTS=1000
+BUFFER_SIZE=16
+MESSAGE_LEN=64
+LOAD_PERCENTS=(10 20 30 40 50 60 70 80 90 95 100)
+ARRIVALS=("constant" "poisson")
+
+# --- Path Configuration ---
+SCRIPT_DIR="$( cd "$( dirname "${BASH_SOURCE[0]}" )" &> /dev/null && pwd )"
+PROJECT_ROOT_DIR="$(dirname "$SCRIPT_DIR")"
+IPC_SRC_DIR="${PROJECT_ROOT_DIR}/src/02_process_ipc_app"
+IPC_PRODUCER_EXE="${IPC_SRC_DIR}/producer"
+IPC_CONSUMER_EXE="${IPC_SRC_DIR}/consumer"
+IPC_RUN_SCRIPT="${IPC_SRC_DIR}/run_ipc_test.sh"
+ITC_SRC="${PROJECT_ROOT_DIR}/src/03_thread_itc_app/thread_producer_consumer.c"
+ITC_EXE="${SCRIPT_DIR}/thread_open_loop"
+
+OUTPUT_FILE="open_loop_results.csv"
+
+cleanup() {
+    rm -f "$ITC_EXE"
+    (cd "$IPC_SRC_DIR" && make clean) > /dev/null 2>&1
+}
+trap cleanup EXIT
+
+# --- FUNCTIONS ---
+
+# build <transport> <extra flags>; returns the command to run, or nothing.
+build() {
+    local transport=$1 flags="-O2 -DBUFFER_SIZE=${BUFFER_SIZE} -DMAX_MESSAGE_LEN=${MESSAGE_LEN} $2"
+    if [ "$transport" = "ITC" ]; then
+        gcc "$ITC_SRC" -o "$ITC_EXE" ${flags} -lpthread -lrt -lm || return 1
+        echo "$ITC_EXE"
+    else
+        (cd "$IPC_SRC_DIR" && make clean && make CFLAGS+="${flags}") > /dev/null 2>&1
+        [ -f "$IPC_PRODUCER_EXE" ] && [ -f "$IPC_CONSUMER_EXE" ] || return 1
+        echo "$IPC_RUN_SCRIPT"
+    fi
+}
+
+# saturation <transport>: average closed-loop messages/s.
+saturation() {
+    local transport=$1 cmd total=0
+    cmd=$(build "$transport" "-DNUM_PRODUCTS=${SATURATION_PRODUCTS}") || return 1
+    for j in $(seq 1 ${SATURATION_RUNS}); do
+        sleep ${REST_INTERVAL_S}
+        comm_time=$("$cmd" | grep '^[0-9\.]\+,[0-9\.]\+' | cut -d',' -f2)
+        total=$(awk -v t="$total" -v c="$comm_time" -v p="$SATURATION_PRODUCTS" 'BEGIN{print t + p/c}')
+    done
+    awk -v t="$total" -v n="$SATURATION_RUNS" 'BEGIN{printf "%.0f\n", t/n}'
+}
+
+
+# --- MAIN EXECUTION ---
+echo "Transport,Arrival,LoadPct,SaturationRate,OfferedRate,AchievedRate,Run,MeanNs,P50Ns,P90Ns,P99Ns,P999Ns,MaxNs" > "$OUTPUT_FILE"
+
+for transport in ITC IPC; do
+    echo "----------------------------------------------------"
+    echo ">> ${transport}: measuring closed-loop saturation..."
+    sat_rate=$(saturation "$transport")
+    if [ -z "$sat_rate" ]; then echo "    !! ${transport} compilation failed"; continue; fi
+    echo "   saturation: ${sat_rate} msgs/s"
+
+    for arrival in "${ARRIVALS[@]}"; do
+        arrival_flag=""
+        [ "$arrival" = "poisson" ] && arrival_flag="-DPOISSON_ARRIVALS"
+
+        for load in "${LOAD_PERCENTS[@]}"; do
+            rate=$(awk -v s="$sat_rate" -v l="$load" 'BEGIN{r=int(s*l/100); print (r < 1 ? 1 : r)}')
+            products=$(awk -v r="$rate" -v d="$RUN_DURATION_S" -v m="$MIN_PRODUCTS" 'BEGIN{p=int(r*d); print (p < m ? m : p)}')
+            cmd=$(build "$transport" "-DOPEN_LOOP -DTARGET_RATE=${rate} -DNUM_PRODUCTS=${products} ${arrival_flag}")
+            if [ -z "$cmd" ]; then echo "    !! ${transport} compilation failed"; continue; fi
+
+            for j in $(seq 1 ${NUM_RUNS}); do
+                echo -ne "   - ${arrival} ${load}% (${rate} msgs/s) run ${j}/${NUM_RUNS}...\r"
+                sleep ${REST_INTERVAL_S}
+                # init,comm,offered,achieved,mean,p50,p90,p99,p99.9,max
+                result=$("$cmd" | grep '^[0-9\.]\+,[0-9\.]\+,')
+                echo "$result" | awk -F',' -v t="$transport" -v a="$arrival" -v l="$load" -v s="$sat_rate" -v j="$j" \
+                    'NF==10{printf "%s,%s,%s,%s,%s,%s,%s,%s,%s,%s,%s,%s,%s\n", t, a, l, s, $3, $4, j, $5, $6, $7, $8, $9, $10}' \
+                    >> "$OUTPUT_FILE"
+            done
+            echo ""
+        done
+    done
+done
+
+echo "----------------------------------------------------"
+echo ">> Complete. Results are in ${OUTPUT_FILE}"
@@ -0,0 +1,95 @@
+#!/bin/bash
+
+# ==============================================================================
+# Per-CPU Queue Test Script (rseq per-CPU rings vs shared queues)
+#
+# Runs src/04_scaling_bench/scaling_bench with a growing number of producer
+# threads against a fixed number of consumers, for the rseq per-CPU backend
+# and the shared-queue backends, and reports throughput together with the
+# cache-miss counts from `perf stat` (per message), so the cost of the
+# contended shared head/tail lines can be read off as producers are added.
+#
+# If `perf` is unavailable (or perf_event_paranoid forbids it) the cache
+# columns stay 0.
+# ==============================================================================
+
+# --- Configuration ---
+NUM_RUNS=3
+MESSAGE_COUNT=1000000
+BUFFER_SIZE=64
+MESSAGE_LEN=64
+PRODUCER_COUNTS=(1 2 4 8 16 32 64)
+CONSUMER_COUNT=2
+MODEL="thread"
+BACKENDS=("percpu" "sharded" "spin" "mutex" "sem")
+PIN_FLAG=""                 # "-a" pins workers round-robin to CPUs
+PERF_EVENTS="cache-references,cache-misses"
+
+# --- Path Configuration ---
+SCRIPT_DIR="$( cd "$( dirname "${BASH_SOURCE[0]}" )" &> /dev/null && pwd )"
+PROJECT_ROOT_DIR="$(dirname "$SCRIPT_DIR")"
+BENCH_SRC_DIR="${PROJECT_ROOT_DIR}/src/04_scaling_bench"
+BENCH_EXE="${BENCH_SRC_DIR}/scaling_bench"
+STAT_FILE="${SCRIPT_DIR}/percpu_stat.tmp"
+
+OUTPUT_FILE="percpu_results.csv"
+
+PERF_AVAILABLE=true
+if ! perf stat -x, -e "$PERF_EVENTS" -o /dev/null -- true > /dev/null 2>&1; then
+    echo "!! WARNING: 'perf stat' is not usable here, cache columns will be 0."
+    PERF_AVAILABLE=false
+fi
+
+cleanup() {
+    rm -f "$STAT_FILE"
+    (cd "$BENCH_SRC_DIR" && make clean) > /dev/null 2>&1
+}
+trap cleanup EXIT
+
+# read_counter <perf stat -x, file> <event name>
+read_counter() {
+    awk -F',' -v ev="$2" '$3==ev{v=$1+0} END{print v+0}' "$1"
+}
+
+
+# --- MAIN EXECUTION ---
+(cd "$BENCH_SRC_DIR" && make clean && make CFLAGS+="-O2 -DBUFFER_SIZE=${BUFFER_SIZE} -DMAX_MESSAGE_LEN=${MESSAGE_LEN}") > /dev/null 2>&1
+if [ ! -f "$BENCH_EXE" ]; then
+    echo "!! scaling_bench compilation failed"
+    exit 1
+fi
+
+echo "Model,Backend,Producers,Consumers,Messages,AvgMsgsPerSec,AvgBlocksPerMsg,AvgCacheRefsPerMsg,AvgCacheMissesPerMsg" > "$OUTPUT_FILE"
+
+for backend in "${BACKENDS[@]}"; do
+    echo "----------------------------------------------------"
+    echo ">> ${MODEL} / ${backend}"
+    for producers in "${PRODUCER_COUNTS[@]}"; do
+        echo -ne "   - ${producers}P:${CONSUMER_COUNT}C...          \r"
+        total_rate=0; total_blocks=0; total_refs=0; total_miss=0; n=0
+        for j in $(seq 1 ${NUM_RUNS}); do
+            cmd=("$BENCH_EXE" -m "$MODEL" -b "$backend" -p "$producers" -c "$CONSUMER_COUNT" -n "$MESSAGE_COUNT" $PIN_FLAG)
+            if [ "$PERF_AVAILABLE" = true ]; then
+                result=$(perf stat -x, -e "$PERF_EVENTS" -o "$STAT_FILE" "${cmd[@]}")
+                total_refs=$(( total_refs + $(read_counter "$STAT_FILE" cache-references) ))
+                total_miss=$(( total_miss + $(read_counter "$STAT_FILE" cache-misses) ))
+            else
+                result=$("${cmd[@]}")
+            fi
+            [ -z "$result" ] && continue
+            total_rate=$(awk -v t="$total_rate" -v r="$(echo "$result" | cut -d',' -f7)" 'BEGIN{print t+r}')
+            total_blocks=$(awk -v t="$total_blocks" -v b="$(echo "$result" | cut -d',' -f9)" 'BEGIN{print t+b}')
+            n=$(( n + 1 ))
+        done
+        if [ "$n" -eq 0 ]; then echo "    !! ${producers}P failed"; continue; fi
+
+        awk -v mo="$MODEL" -v b="$backend" -v p="$producers" -v c="$CONSUMER_COUNT" -v m="$MESSAGE_COUNT" -v n="$n" \
+            -v rate="$total_rate" -v blocks="$total_blocks" -v refs="$total_refs" -v miss="$total_miss" \
+            'BEGIN{printf "%s,%s,%s,%s,%s,%.0f,%.4f,%.3f,%.3f\n", mo, b, p, c, m, rate/n, blocks/n, refs/n/m, miss/n/m}' \
+            >> "$OUTPUT_FILE"
+    done
+    echo ""
+done
+
+echo "----------------------------------------------------"
+echo ">> Complete. Results are in ${OUTPUT_FILE}"
@@ -0,0 +1,97 @@
+#!/bin/bash
+
+# ==============================================================================
+# Rendezvous Test Script (named sem_open polling vs memfd + SCM_RIGHTS)
+#
+# Starts PAIR_COUNTS producer/consumer pairs at the same time. The default
+# build meets on the global /ready_semaphore and /my_share_memory names, so
+# it only runs as a single pair; the -DMEMFD_RENDEZVOUS build gives every
+# pair its own IPC_CHANNEL and reports the consumer's attach latency (the
+# producer's sendmsg() to a mapped segment).
+# ==============================================================================
+
+# --- Configuration ---
+NUM_RUNS=20
+REST_INTERVAL_S=0.1
+PRODUCT_COUNT=10000
+BUFFER_SIZE=4
+MESSAGE_LEN=64
+PAIR_COUNTS=(1 2 4 8 16)
+
+# --- Path Configuration ---
+SCRIPT_DIR="$( cd "$( dirname "${BASH_SOURCE[0]}" )" &> /dev/null && pwd )"
+PROJECT_ROOT_DIR="$(dirname "$SCRIPT_DIR")"
+IPC_SRC_DIR="${PROJECT_ROOT_DIR}/src/02_process_ipc_app"
+IPC_PRODUCER_EXE="${IPC_SRC_DIR}/producer"
+IPC_CONSUMER_EXE="${IPC_SRC_DIR}/consumer"
+RUN_OUTPUT="${SCRIPT_DIR}/rendezvous_run.tmp"
+
+OUTPUT_FILE="rendezvous_results.csv"
+
+cleanup() {
+    rm -f "$RUN_OUTPUT"
+    (cd "$IPC_SRC_DIR" && make clean) > /dev/null 2>&1
+}
+trap cleanup EXIT
+
+# --- FUNCTIONS ---
+
+# run_pairs <pairs>: start all pairs at once, output lines go to $RUN_OUTPUT.
+run_pairs() {
+    local pairs=$1
+    : > "$RUN_OUTPUT"
+    for p in $(seq 1 ${pairs}); do
+        IPC_CHANNEL="pair${p}.$$" "$IPC_CONSUMER_EXE" >> "$RUN_OUTPUT" &
+        IPC_CHANNEL="pair${p}.$$" "$IPC_PRODUCER_EXE" >> "$RUN_OUTPUT" &
+    done
+    wait
+}
+
+# measure <mode> <pairs>
+measure() {
+    local mode=$1 pairs=$2
+
+    for j in $(seq 1 ${NUM_RUNS}); do
+        echo -ne "       - ${mode} pairs=${pairs} run ${j}/${NUM_RUNS}...\r"
+        sleep ${REST_INTERVAL_S}
+        run_pairs "$pairs"
+        # attach_ns,<ns> from consumers; init,comm from producers.
+        awk -F',' -v mode="$mode" -v pairs="$pairs" -v run="$j" '
+            $1=="attach_ns" {attach_sum+=$2; if($2>attach_max) attach_max=$2; attached++}
+            /^[0-9\.]+,[0-9\.]+/ {init_sum+=$1; if($1>init_max) init_max=$1; done++}
+            END{
+                if(attached) printf "%s,%s,%s,%d,%.0f,%.0f,", mode, pairs, run, done, attach_sum/attached, attach_max
+                else printf "%s,%s,%s,%d,,,", mode, pairs, run, done
+                printf "%.9f,%.9f\n", (done ? init_sum/done : 0), init_max
+            }' "$RUN_OUTPUT" >> "$OUTPUT_FILE"
+    done
+    echo ""
+}
+
+
+# --- MAIN EXECUTION ---
+echo "Mode,Pairs,Run,CompletedPairs,AvgAttachNs,MaxAttachNs,AvgInitTime,MaxInitTime" > "$OUTPUT_FILE"
+BUILD_FLAGS="-O2 -DNUM_PRODUCTS=${PRODUCT_COUNT} -DBUFFER_SIZE=${BUFFER_SIZE} -DMAX_MESSAGE_LEN=${MESSAGE_LEN}"
+
+echo "----------------------------------------------------"
+echo ">> named (sem_open polling), single pair"
+(cd "$IPC_SRC_DIR" && make clean && make CFLAGS+="${BUILD_FLAGS}") > /dev/null 2>&1
+if [ -f "$IPC_PRODUCER_EXE" ] && [ -f "$IPC_CONSUMER_EXE" ]; then
+    measure "named" 1
+else
+    echo "    !! IPC compilation failed"
+fi
+
+echo "----------------------------------------------------"
+echo ">> memfd + SCM_RIGHTS"
+(cd "$IPC_SRC_DIR" && make clean && make CFLAGS+="${BUILD_FLAGS} -DMEMFD_RENDEZVOUS") > /dev/null 2>&1
+if [ -f "$IPC_PRODUCER_EXE" ] && [ -f "$IPC_CONSUMER_EXE" ]; then
+    for pairs in "${PAIR_COUNTS[@]}"; do
+        measure "memfd" "$pairs"
+    done
+else
+    echo "    !! IPC compilation failed"
+fi
+
+echo "----------------------------------------------------"
+echo ">> Complete. Results are in ${OUTPUT_FILE}"
@@ -0,0 +1,61 @@
+#!/bin/bash
+
+# ==============================================================================
+# Ping-pong RPC Test Script (request/reply round trips)
+#
+# Runs src/04_scaling_bench/rpc_bench for the thread and the process model,
+# every backend in BACKENDS and every window in OUTSTANDING (1 = strict
+# ping-pong), and writes RPCs/sec plus the round-trip latency distribution
+# (ns), each averaged over NUM_RUNS runs.
+# ==============================================================================
+
+# --- Configuration ---
+NUM_RUNS=5
+RPC_COUNT=200000
+BUFFER_SIZE=64
+MESSAGE_LEN=64
+OUTSTANDING=(1 2 4 8 16 32 64)
+MODELS=("thread" "process")
+BACKENDS=("sem" "mutex" "sharded" "spin" "eventfd")
+PIN_FLAG=""                 # "-a" pins client and server to CPUs 0 and 1
+
+# --- Path Configuration ---
+SCRIPT_DIR="$( cd "$( dirname "${BASH_SOURCE[0]}" )" &> /dev/null && pwd )"
+PROJECT_ROOT_DIR="$(dirname "$SCRIPT_DIR")"
+BENCH_SRC_DIR="${PROJECT_ROOT_DIR}/src/04_scaling_bench"
+RPC_EXE="${BENCH_SRC_DIR}/rpc_bench"
+
+OUTPUT_FILE="rpc_results.csv"
+
+cleanup() {
+    (cd "$BENCH_SRC_DIR" && make clean) > /dev/null 2>&1
+}
+trap cleanup EXIT
+
+
+# --- MAIN EXECUTION ---
+(cd "$BENCH_SRC_DIR" && make clean && make CFLAGS+="-O2 -DBUFFER_SIZE=${BUFFER_SIZE} -DMAX_MESSAGE_LEN=${MESSAGE_LEN}") > /dev/null 2>&1
+if [ ! -f "$RPC_EXE" ]; then
+    echo "!! rpc_bench compilation failed"
+    exit 1
+fi
+
+echo "Model,Backend,Outstanding,Rpcs,ElapsedS,RpcsPerSec,BlocksPerRpc,RttMean,RttP50,RttP90,RttP99,RttP999,RttMax" > "$OUTPUT_FILE"
+
+for model in "${MODELS[@]}"; do
+    for backend in "${BACKENDS[@]}"; do
+        echo "----------------------------------------------------"
+        echo ">> ${model} / ${backend}"
+        for window in "${OUTSTANDING[@]}"; do
+            echo "   - outstanding=${window}: ${NUM_RUNS} runs..."
+            for j in $(seq 1 ${NUM_RUNS}); do
+                "$RPC_EXE" -m "$model" -b "$backend" -n "$RPC_COUNT" -o "$window" $PIN_FLAG
+            done | awk -F',' 'NF==13 {n++; for(k=5;k<=13;k++) s[k]+=$k; head=$1","$2","$3","$4}
+                END{if(n){printf "%s,%.9f,%.0f,%.4f", head, s[5]/n, s[6]/n, s[7]/n; for(k=8;k<=13;k++) printf ",%.0f", s[k]/n; printf "\n"}}' \
+                >> "$OUTPUT_FILE"
+        done
+    done
+done
+
+echo "----------------------------------------------------"
+echo ">> Complete. Results are in ${OUTPUT_FILE}"
@@ -0,0 +1,85 @@
+#!/bin/bash
+
+# ==============================================================================
+# Scaling Matrix Test Script (M producers : N consumers)
+#
+# Runs src/04_scaling_bench/scaling_bench for every producer/consumer count
+# pair in WORKER_COUNTS, for the thread and the process model, every
+# backend in BACKENDS and with/without CPU pinning, and writes the averaged
+# throughput, contention metrics, producer fairness (Jain's index) and
+# per-worker efficiency relative to the same configuration at 1:1
+# (1.0 = perfect scaling, <1 = each extra worker buys less than the first
+# two did).
+# ==============================================================================
+
+# --- Configuration ---
+NUM_RUNS=3
+MESSAGE_COUNT=1000000
+BUFFER_SIZE=64
+MESSAGE_LEN=64
+WORKER_COUNTS=(1 2 4 8 16 32)
+MODELS=("thread" "process")
+BACKENDS=("sem" "mutex" "sharded" "spin" "percpu" "eventfd")
+AFFINITY=("none" "pinned")
+
+# --- Path Configuration ---
+SCRIPT_DIR="$( cd "$( dirname "${BASH_SOURCE[0]}" )" &> /dev/null && pwd )"
+PROJECT_ROOT_DIR="$(dirname "$SCRIPT_DIR")"
+BENCH_SRC_DIR="${PROJECT_ROOT_DIR}/src/04_scaling_bench"
+BENCH_EXE="${BENCH_SRC_DIR}/scaling_bench"
+RUNS_FILE="${SCRIPT_DIR}/scaling_runs.tmp"
+
+OUTPUT_FILE="scaling_results.csv"
+
+cleanup() {
+    rm -f "$RUNS_FILE"
+    (cd "$BENCH_SRC_DIR" && make clean) > /dev/null 2>&1
+}
+trap cleanup EXIT
+
+
+# --- MAIN EXECUTION ---
+(cd "$BENCH_SRC_DIR" && make clean && make CFLAGS+="-O2 -DBUFFER_SIZE=${BUFFER_SIZE} -DMAX_MESSAGE_LEN=${MESSAGE_LEN}") > /dev/null 2>&1
+if [ ! -f "$BENCH_EXE" ]; then
+    echo "!! scaling_bench compilation failed"
+    exit 1
+fi
+
+echo ">> $(nproc) online CPUs"
+echo "Model,Backend,Affinity,Producers,Consumers,Messages,ElapsedS,MsgsPerSec,MsgsPerSecPerWorker,BlocksPerMsg,VcswPerMsg,IvcswPerMsg,CpuS,ProducerFairness,Efficiency" > "$OUTPUT_FILE"
+
+for model in "${MODELS[@]}"; do
+    for backend in "${BACKENDS[@]}"; do
+        for affinity in "${AFFINITY[@]}"; do
+            echo "----------------------------------------------------"
+            echo ">> ${model} / ${backend} / ${affinity}"
+            pin_flag=""
+            [ "$affinity" = "pinned" ] && pin_flag="-a"
+            base_per_worker=""
+
+            for producers in "${WORKER_COUNTS[@]}"; do
+                for consumers in "${WORKER_COUNTS[@]}"; do
+                    echo -ne "   - ${producers}P:${consumers}C...          \r"
+                    : > "$RUNS_FILE"
+                    for j in $(seq 1 ${NUM_RUNS}); do
+                        "$BENCH_EXE" -m "$model" -b "$backend" -p "$producers" -c "$consumers" -n "$MESSAGE_COUNT" $pin_flag >> "$RUNS_FILE"
+                    done
+
+                    # model,backend,P,C,messages,elapsed,rate,rate/worker,blocks,vcsw,ivcsw,cpu,fairness
+                    line=$(awk -F',' -v aff="$affinity" '
+                        NF==13 {n++; for(k=6;k<=13;k++) s[k]+=$k; head=$1","$2","aff","$3","$4","$5}
+                        END{if(n){printf "%s,%.9f,%.0f,%.0f,%.4f,%.4f,%.4f,%.3f,%.4f", head, s[6]/n, s[7]/n, s[8]/n, s[9]/n, s[10]/n, s[11]/n, s[12]/n, s[13]/n}}' "$RUNS_FILE")
+                    if [ -z "$line" ]; then echo "    !! ${producers}P:${consumers}C failed"; continue; fi
+
+                    per_worker=$(echo "$line" | cut -d',' -f9)
+                    [ -z "$base_per_worker" ] && base_per_worker="$per_worker"
+                    awk -v l="$line" -v w="$per_worker" -v b="$base_per_worker" 'BEGIN{printf "%s,%.3f\n", l, w/b}' >> "$OUTPUT_FILE"
+                done
+            done
+            echo ""
+        done
+    done
+done
+
+echo "----------------------------------------------------"
+echo ">> Complete. Results are in ${OUTPUT_FILE}"
@@ -0,0 +1,65 @@
+#!/bin/bash
+
+# ==============================================================================
+# Out-of-band Payload Test Script (inline ring slots vs -DSLAB_ARENA)
+#
+# Builds the IPC app with the payload copied into the ring slot (default)
+# and with the payload in a slab-arena block and only a 16-byte descriptor
+# in the ring (-DSLAB_ARENA), and reports average communication time,
+# payload bandwidth and the size of the ring itself for each message size.
+# Runs go through the fork launcher, NUM_RUNS rounds per process pair.
+# ==============================================================================
+
+# --- Configuration ---
+NUM_RUNS=20
+PRODUCT_COUNT=20000
+BUFFER_SIZES=(4 64)
+MESSAGE_LENS=(64 1500 16384 64000)
+PAYLOAD_MODES=("inline" "arena")
+
+# --- Path Configuration ---
+SCRIPT_DIR="$( cd "$( dirname "${BASH_SOURCE[0]}" )" &> /dev/null && pwd )"
+PROJECT_ROOT_DIR="$(dirname "$SCRIPT_DIR")"
+IPC_SRC_DIR="${PROJECT_ROOT_DIR}/src/02_process_ipc_app"
+IPC_LAUNCHER_EXE="${IPC_SRC_DIR}/launcher"
+
+OUTPUT_FILE="slab_arena_results.csv"
+
+cleanup() {
+    (cd "$IPC_SRC_DIR" && make clean) > /dev/null 2>&1
+}
+trap cleanup EXIT
+
+
+# --- MAIN EXECUTION ---
+echo "PayloadMode,ProductCount,BufferSize,MessageLen,RingBytes,AvgCommTime,PayloadMBps" > "$OUTPUT_FILE"
+
+for bsize in "${BUFFER_SIZES[@]}"; do
+    for mlen in "${MESSAGE_LENS[@]}"; do
+        echo "----------------------------------------------------"
+        echo ">> BufferSize=${bsize}, MessageLen=${mlen}"
+        for mode in "${PAYLOAD_MODES[@]}"; do
+            BUILD_FLAGS="-O2 -DNUM_PRODUCTS=${PRODUCT_COUNT} -DBUFFER_SIZE=${bsize} -DMAX_MESSAGE_LEN=${mlen}"
+            ring_bytes=$(( bsize * mlen ))
+            if [ "$mode" = "arena" ]; then
+                BUILD_FLAGS="${BUILD_FLAGS} -DSLAB_ARENA"
+                ring_bytes=$(( bsize * 16 ))
+            fi
+
+            (cd "$IPC_SRC_DIR" && make clean && make CFLAGS+="${BUILD_FLAGS}") > /dev/null 2>&1
+            if [ ! -f "$IPC_LAUNCHER_EXE" ]; then
+                echo "    !! IPC compilation failed"; continue
+            fi
+
+            echo "   - ${mode}: ${NUM_RUNS} rounds..."
+            # one init,comm line per round.
+            "$IPC_LAUNCHER_EXE" -r "$NUM_RUNS" | grep '^[0-9\.]\+,[0-9\.]\+' | \
+                awk -F',' -v mode="$mode" -v p="$PRODUCT_COUNT" -v b="$bsize" -v m="$mlen" -v r="$ring_bytes" \
+                    '{comm+=$2; n++} END{if(n){avg=comm/n; printf "%s,%s,%s,%s,%s,%.9f,%.1f\n", mode, p, b, m, r, avg, p*m/avg/1e6}}' \
+                >> "$OUTPUT_FILE"
+        done
+    done
+done
+
+echo "----------------------------------------------------"
+echo ">> Complete. Results are in ${OUTPUT_FILE}"
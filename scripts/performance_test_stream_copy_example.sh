@@ -0,0 +1,99 @@
+#!/bin/bash
+
+# ==============================================================================
+# Large Message Copy Test Script (memcpy vs non-temporal streaming copy)
+#
+# Builds the IPC and ITC apps with -DUSE_STREAM_COPY=0 (plain memcpy, no
+# prefetch) and -DUSE_STREAM_COPY=1 (non-temporal stores + consumer prefetch)
+# and reports average communication time and payload bandwidth, so the
+# STREAM_COPY_THRESHOLD default can be checked against this machine.
+#
+# Run as root to also collect LLC load misses through `perf stat`.
+# ==============================================================================
+
+# --- Configuration ---
+NUM_RUNS=20
+REST_INTERVAL_S=0.1
+PRODUCT_COUNT=20000
+BUFFER_SIZES=(1 4 16)
+MESSAGE_LENS=(1500 4096 16384 32768 64000)
+COPY_MODES=(0 1)
+
+# --- Path Configuration ---
+SCRIPT_DIR="$( cd "$( dirname "${BASH_SOURCE[0]}" )" &> /dev/null && pwd )"
+PROJECT_ROOT_DIR="$(dirname "$SCRIPT_DIR")"
+IPC_SRC_DIR="${PROJECT_ROOT_DIR}/src/02_process_ipc_app"
+IPC_PRODUCER_EXE="${IPC_SRC_DIR}/producer"
+IPC_CONSUMER_EXE="${IPC_SRC_DIR}/consumer"
+IPC_RUN_SCRIPT="${IPC_SRC_DIR}/run_ipc_test.sh"
+ITC_SRC="${PROJECT_ROOT_DIR}/src/03_thread_itc_app/thread_producer_consumer.c"
+ITC_EXE="${SCRIPT_DIR}/thread_stream_copy"
+
+OUTPUT_FILE="stream_copy_results.csv"
+
+USE_PERF=false
+if [[ $EUID -eq 0 ]] && command -v perf > /dev/null 2>&1; then
+    USE_PERF=true
+fi
+
+cleanup() {
+    rm -f "$ITC_EXE" perf_stat.tmp
+    (cd "$IPC_SRC_DIR" && make clean) > /dev/null 2>&1
+}
+trap cleanup EXIT
+
+# --- FUNCTIONS ---
+
+# measure <test type> <copy mode> <bsize> <mlen> <command...>
+measure() {
+    local type=$1 mode=$2 bsize=$3 mlen=$4
+    shift 4
+    local total_comm=0 total_llc=0
+
+    for j in $(seq 1 ${NUM_RUNS}); do
+        echo -ne "       - ${type} stream=${mode} run ${j}/${NUM_RUNS}...\r"
+        sleep ${REST_INTERVAL_S}
+        if [ "$USE_PERF" = true ]; then
+            result=$(perf stat -x, -e LLC-load-misses -o perf_stat.tmp "$@" | grep '^[0-9\.]\+,[0-9\.]\+')
+            llc=$(awk -F',' '$3=="LLC-load-misses"{v=$1+0} END{print v+0}' perf_stat.tmp)
+            total_llc=$(( total_llc + llc ))
+        else
+            result=$("$@" | grep '^[0-9\.]\+,[0-9\.]\+')
+        fi
+        comm_time=$(echo "$result" | cut -d',' -f2)
+        total_comm=$(awk -v t1="$total_comm" -v t2="$comm_time" 'BEGIN{print t1+t2}')
+    done
+    echo ""
+
+    awk -v type="$type" -v mode="$mode" -v b="$bsize" -v m="$mlen" -v p="$PRODUCT_COUNT" -v n="$NUM_RUNS" \
+        -v comm="$total_comm" -v llc="$total_llc" \
+        'BEGIN{avg=comm/n; printf "%s,%s,%s,%s,%s,%.9f,%.1f,%d\n", type, (mode ? "stream" : "memcpy"), p, b, m, avg, p*m/avg/1e6, llc/n}' \
+        >> "$OUTPUT_FILE"
+}
+
+
+# --- MAIN EXECUTION ---
+echo "TestType,CopyMode,ProductCount,BufferSize,MessageLen,AvgCommTime,PayloadMBps,AvgLLCLoadMisses" > "$OUTPUT_FILE"
+
+for bsize in "${BUFFER_SIZES[@]}"; do
+    for mlen in "${MESSAGE_LENS[@]}"; do
+        echo "----------------------------------------------------"
+        echo ">> BufferSize=${bsize}, MessageLen=${mlen}"
+        for mode in "${COPY_MODES[@]}"; do
+            BUILD_FLAGS="-O2 -DNUM_PRODUCTS=${PRODUCT_COUNT} -DBUFFER_SIZE=${bsize} -DMAX_MESSAGE_LEN=${mlen} -DUSE_STREAM_COPY=${mode}"
+
+            gcc "$ITC_SRC" -o "$ITC_EXE" ${BUILD_FLAGS} -lpthread -lrt
+            if [ $? -ne 0 ]; then echo "    !! ITC compilation failed"; continue; fi
+            measure "ITC" "$mode" "$bsize" "$mlen" "$ITC_EXE"
+
+            (cd "$IPC_SRC_DIR" && make clean && make CFLAGS+="${BUILD_FLAGS}") > /dev/null 2>&1
+            if [ ! -f "$IPC_PRODUCER_EXE" ] || [ ! -f "$IPC_CONSUMER_EXE" ]; then
+                echo "    !! IPC compilation failed"; continue
+            fi
+            measure "IPC" "$mode" "$bsize" "$mlen" "$IPC_RUN_SCRIPT"
+        done
+    done
+done
+
+echo "----------------------------------------------------"
+echo ">> Complete. Results are in ${OUTPUT_FILE}"
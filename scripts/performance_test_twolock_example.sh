@@ -0,0 +1,59 @@
+#!/bin/bash
+
+# ==============================================================================
+# Two-lock Queue Test Script (single mutex vs head/tail locks)
+#
+# Builds the ITC app's single-mutex design (thread_producer_consumer.c) and
+# the two-lock, waiter-aware variant (thread_producer_consumer_twolock.c)
+# with the same settings, and reports the average communication time and
+# throughput of each for every buffer size and message length.
+# ==============================================================================
+
+# --- Configuration ---
+NUM_RUNS=10
+PRODUCT_COUNT=100000
+BUFFER_SIZES=(1 2 4 16 64 256)
+MESSAGE_LENS=(64 1024)
+VARIANTS=("mutex" "twolock")
+
+# --- Path Configuration ---
+SCRIPT_DIR="$( cd "$( dirname "${BASH_SOURCE[0]}" )" &> /dev/null && pwd )"
+PROJECT_ROOT_DIR="$(dirname "$SCRIPT_DIR")"
+ITC_SRC_DIR="${PROJECT_ROOT_DIR}/src/03_thread_itc_app"
+ITC_EXE="${SCRIPT_DIR}/thread_twolock_test"
+
+OUTPUT_FILE="twolock_results.csv"
+
+cleanup() {
+    rm -f "$ITC_EXE"
+}
+trap cleanup EXIT
+
+
+# --- MAIN EXECUTION ---
+echo "Variant,ProductCount,BufferSize,MessageLen,AvgCommTime,MsgsPerSec" > "$OUTPUT_FILE"
+
+for bsize in "${BUFFER_SIZES[@]}"; do
+    for mlen in "${MESSAGE_LENS[@]}"; do
+        echo "----------------------------------------------------"
+        echo ">> BufferSize=${bsize}, MessageLen=${mlen}"
+        for variant in "${VARIANTS[@]}"; do
+            src="${ITC_SRC_DIR}/thread_producer_consumer.c"
+            [ "$variant" = "twolock" ] && src="${ITC_SRC_DIR}/thread_producer_consumer_twolock.c"
+
+            gcc -O2 "$src" -o "$ITC_EXE" -DNUM_PRODUCTS=${PRODUCT_COUNT} -DBUFFER_SIZE=${bsize} -DMAX_MESSAGE_LEN=${mlen} -lpthread -lrt -lm
+            if [ $? -ne 0 ]; then echo "    !! ${variant} compilation failed"; continue; fi
+
+            echo "   - ${variant}: ${NUM_RUNS} runs..."
+            for j in $(seq 1 ${NUM_RUNS}); do
+                "$ITC_EXE"
+            done | grep '^[0-9\.]\+,[0-9\.]\+' | \
+                awk -F',' -v v="$variant" -v p="$PRODUCT_COUNT" -v b="$bsize" -v m="$mlen" \
+                    '{comm+=$2; n++} END{if(n){avg=comm/n; printf "%s,%s,%s,%s,%.9f,%.0f\n", v, p, b, m, avg, p/avg}}' \
+                >> "$OUTPUT_FILE"
+        done
+    done
+done
+
+echo "----------------------------------------------------"
+echo ">> Complete. Results are in ${OUTPUT_FILE}"
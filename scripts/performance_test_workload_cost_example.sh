@@ -0,0 +1,95 @@
+#!/bin/bash
+
+# ==============================================================================
+# Per-message Work Cost Test Script (compute-to-communication ratio)
+#
+# Builds the IPC and ITC apps once per buffer size and runs them with every
+# consumer workload in WORKLOADS (selected at run time through the WORKLOAD
+# environment variable, see src/common/workload.h). The spin:<ns> steps show
+# where the synchronization cost stops mattering: once NsPerMsg tracks WorkNs
+# the transport is no longer the bottleneck.
+# ==============================================================================
+
+# --- Configuration ---
+NUM_RUNS=10
+REST_INTERVAL_S=0.1
+PRODUCT_COUNT=50000
+BUFFER_SIZES=(1 16)
+MESSAGE_LEN=256
+WORKLOADS=("none" "checksum" "crc32c" "xxhash" "parse" "spin:100" "spin:250" "spin:500" "spin:1000" "spin:2500" "spin:5000" "spin:10000")
+PRODUCER_WORKLOAD="none"
+
+# --- Path Configuration ---
+SCRIPT_DIR="$( cd "$( dirname "${BASH_SOURCE[0]}" )" &> /dev/null && pwd )"
+PROJECT_ROOT_DIR="$(dirname "$SCRIPT_DIR")"
+IPC_SRC_DIR="${PROJECT_ROOT_DIR}/src/02_process_ipc_app"
+IPC_PRODUCER_EXE="${IPC_SRC_DIR}/producer"
+IPC_CONSUMER_EXE="${IPC_SRC_DIR}/consumer"
+IPC_RUN_SCRIPT="${IPC_SRC_DIR}/run_ipc_test.sh"
+ITC_SRC="${PROJECT_ROOT_DIR}/src/03_thread_itc_app/thread_producer_consumer.c"
+ITC_EXE="${SCRIPT_DIR}/thread_workload_cost"
+
+OUTPUT_FILE="workload_cost_results.csv"
+
+cleanup() {
+    rm -f "$ITC_EXE"
+    (cd "$IPC_SRC_DIR" && make clean) > /dev/null 2>&1
+}
+trap cleanup EXIT
+
+# --- FUNCTIONS ---
+
+# measure <test type> <bsize> <workload> <command...>
+measure() {
+    local type=$1 bsize=$2 work=$3
+    shift 3
+    local total_comm=0
+
+    for j in $(seq 1 ${NUM_RUNS}); do
+        echo -ne "       - ${type} ${work} run ${j}/${NUM_RUNS}...\r"
+        sleep ${REST_INTERVAL_S}
+        result=$(WORKLOAD="$work" PRODUCER_WORKLOAD="$PRODUCER_WORKLOAD" "$@" | grep '^[0-9\.]\+,[0-9\.]\+')
+        comm_time=$(echo "$result" | cut -d',' -f2)
+        total_comm=$(awk -v t1="$total_comm" -v t2="$comm_time" 'BEGIN{print t1+t2}')
+    done
+    echo ""
+
+    # WorkNs is only known up front for the spin workload.
+    local work_ns=""
+    [[ "$work" == spin:* ]] && work_ns=${work#spin:}
+
+    awk -v type="$type" -v w="$work" -v wn="$work_ns" -v pw="$PRODUCER_WORKLOAD" -v b="$bsize" -v m="$MESSAGE_LEN" \
+        -v p="$PRODUCT_COUNT" -v n="$NUM_RUNS" -v comm="$total_comm" \
+        'BEGIN{avg=comm/n; printf "%s,%s,%s,%s,%s,%s,%s,%.9f,%.0f,%.1f\n", type, w, wn, pw, p, b, m, avg, p/avg, avg/p*1e9}' \
+        >> "$OUTPUT_FILE"
+}
+
+
+# --- MAIN EXECUTION ---
+echo "TestType,Workload,WorkNs,ProducerWorkload,ProductCount,BufferSize,MessageLen,AvgCommTime,MsgsPerSec,NsPerMsg" > "$OUTPUT_FILE"
+
+for bsize in "${BUFFER_SIZES[@]}"; do
+    echo "----------------------------------------------------"
+    echo ">> BufferSize=${bsize}, MessageLen=${MESSAGE_LEN}"
+    BUILD_FLAGS="-O2 -DNUM_PRODUCTS=${PRODUCT_COUNT} -DBUFFER_SIZE=${bsize} -DMAX_MESSAGE_LEN=${MESSAGE_LEN}"
+
+    gcc "$ITC_SRC" -o "$ITC_EXE" ${BUILD_FLAGS} -lpthread -lrt -lm
+    ITC_OK=$?
+    (cd "$IPC_SRC_DIR" && make clean && make CFLAGS+="${BUILD_FLAGS}") > /dev/null 2>&1
+
+    for work in "${WORKLOADS[@]}"; do
+        if [ $ITC_OK -eq 0 ]; then
+            measure "ITC" "$bsize" "$work" "$ITC_EXE"
+        else
+            echo "    !! ITC compilation failed"
+        fi
+        if [ -f "$IPC_PRODUCER_EXE" ] && [ -f "$IPC_CONSUMER_EXE" ]; then
+            measure "IPC" "$bsize" "$work" "$IPC_RUN_SCRIPT"
+        else
+            echo "    !! IPC compilation failed"
+        fi
+    done
+done
+
+echo "----------------------------------------------------"
+echo ">> Complete. Results are in ${OUTPUT_FILE}"
@@ -0,0 +1,49 @@
+#!/bin/bash
+
+# ==============================================================================
+# Handoff Trace Script (no root, no perf, no FlameGraph)
+#
+# Builds the ITC and IPC apps with -DTRACE, runs them once, and converts the
+# per-thread binary traces into Chrome trace JSON with trace_to_json.py.
+# Open the .json files in chrome://tracing or https://ui.perfetto.dev to see
+# every enqueue -> dequeue handoff and every block/wake at ns resolution.
+# ==============================================================================
+
+set -e
+
+# --- Configuration ---
+PRODUCT_COUNT=100000
+BUFFER_SIZE=4
+MESSAGE_LEN=64
+
+# --- Path Configuration ---
+SCRIPT_DIR="$( cd "$( dirname "${BASH_SOURCE[0]}" )" &> /dev/null && pwd )"
+PROJECT_ROOT_DIR="$(dirname "$SCRIPT_DIR")"
+THREAD_SRC="${PROJECT_ROOT_DIR}/src/03_thread_itc_app/thread_producer_consumer.c"
+THREAD_EXE="${SCRIPT_DIR}/thread_trace"
+IPC_APP_DIR="${PROJECT_ROOT_DIR}/src/02_process_ipc_app"
+IPC_RUN_SCRIPT="${IPC_APP_DIR}/run_ipc_test.sh"
+RESULTS_DIR="${SCRIPT_DIR}/trace_results"
+BUILD_FLAGS="-g -DTRACE -DNUM_PRODUCTS=${PRODUCT_COUNT} -DBUFFER_SIZE=${BUFFER_SIZE} -DMAX_MESSAGE_LEN=${MESSAGE_LEN}"
+
+mkdir -p "${RESULTS_DIR}/itc" "${RESULTS_DIR}/ipc"
+rm -f "${RESULTS_DIR}"/itc/trace_*.bin "${RESULTS_DIR}"/ipc/trace_*.bin
+
+cleanup() {
+    rm -f "$THREAD_EXE"
+    (cd "${IPC_APP_DIR}" && make clean) > /dev/null 2>&1
+}
+trap cleanup EXIT
+
+echo ">> [1/2] ITC (thread) model..."
+gcc "${THREAD_SRC}" -o "${THREAD_EXE}" ${BUILD_FLAGS} -lpthread -lrt
+# trace files land in the current directory (TRACE_DIR).
+(cd "${RESULTS_DIR}/itc" && "${THREAD_EXE}")
+python3 "${SCRIPT_DIR}/trace_to_json.py" "${RESULTS_DIR}/itc" -o "${RESULTS_DIR}/itc_trace.json"
+
+echo ">> [2/2] IPC (process) model..."
+(cd "${IPC_APP_DIR}" && make clean && make CFLAGS+="${BUILD_FLAGS}") > /dev/null
+(cd "${RESULTS_DIR}/ipc" && "${IPC_RUN_SCRIPT}")
+python3 "${SCRIPT_DIR}/trace_to_json.py" "${RESULTS_DIR}/ipc" -o "${RESULTS_DIR}/ipc_trace.json"
+
+echo ">> Complete. Open ${RESULTS_DIR}/itc_trace.json and ${RESULTS_DIR}/ipc_trace.json in ui.perfetto.dev"
@@ -0,0 +1,136 @@
+#!/usr/bin/env python3
+"""
+Convert the binary trace files written by a -DTRACE build (see
+src/common/trace.h) into Chrome trace-event JSON, viewable in
+chrome://tracing or https://ui.perfetto.dev.
+
+    ./trace_to_json.py trace_*.bin -o handoff.json
+
+Pass the files of ONE run: every message sequence number becomes a flow
+arrow from the producer's enqueue to the consumer's dequeue, so mixing runs
+would connect unrelated events.
+
+Output:
+  - "blocked on <resource>" slices for every block -> wake pair,
+  - enqueue/dequeue markers carrying the message sequence number,
+  - flow arrows linking each enqueue to its dequeue.
+"""
+
+import argparse
+import glob
+import json
+import os
+import struct
+import sys
+
+TRACE_MAGIC = 0x45434152544C4350  # "PCLTRACE"
+HEADER_FORMAT = "<QIIQQQQQQII32s"
+HEADER_SIZE = 4096
+RECORD_FORMAT = "<QQIHH"
+
+EVENTS = {1: "enqueue", 2: "dequeue", 3: "block", 4: "wake"}
+RESOURCES = {0: "none", 1: "lock", 2: "space", 3: "product"}
+
+
+def read_trace(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    (magic, version, record_size, capacity, head, start_tsc, start_ns,
+     end_tsc, end_ns, pid, tid, name) = struct.unpack_from(HEADER_FORMAT, data, 0)
+    if magic != TRACE_MAGIC:
+        raise ValueError(f"{path}: not a trace file")
+    if record_size != struct.calcsize(RECORD_FORMAT):
+        raise ValueError(f"{path}: unsupported record size {record_size} (version {version})")
+
+    if end_tsc > start_tsc and end_ns > start_ns:
+        ticks_per_ns = (end_tsc - start_tsc) / (end_ns - start_ns)
+    else:
+        print(f"!! {path}: trace was not closed, assuming 1 tick per ns", file=sys.stderr)
+        ticks_per_ns = 1.0
+
+    # the ring keeps the newest `capacity` records.
+    count = min(head, capacity)
+    first = head - count
+    records = []
+    for n in range(first, head):
+        offset = HEADER_SIZE + (n % capacity) * record_size
+        tsc, arg, rec_tid, event, resource = struct.unpack_from(RECORD_FORMAT, data, offset)
+        ns = start_ns + (tsc - start_tsc) / ticks_per_ns
+        records.append((ns, event, resource, arg))
+    if head > capacity:
+        print(f"!! {path}: ring wrapped, the oldest {head - capacity} records are lost", file=sys.stderr)
+
+    return {
+        "pid": pid,
+        "tid": tid,
+        "name": name.split(b"\0", 1)[0].decode(errors="replace"),
+        "start_ns": start_ns,
+        "records": records,
+    }
+
+
+def convert(traces, flows):
+    t0 = min(t["start_ns"] for t in traces)
+    events = []
+
+    def us(ns):
+        return (ns - t0) / 1000.0
+
+    for t in traces:
+        pid, tid = t["pid"], t["tid"]
+        events.append({"ph": "M", "name": "process_name", "pid": pid, "tid": tid,
+                       "args": {"name": f"{t['name']} ({pid})"}})
+        events.append({"ph": "M", "name": "thread_name", "pid": pid, "tid": tid,
+                       "args": {"name": t["name"]}})
+
+        blocked_since = {}
+        for ns, event, resource, arg in t["records"]:
+            kind = EVENTS.get(event, str(event))
+            res = RESOURCES.get(resource, str(resource))
+            if kind == "block":
+                blocked_since[resource] = (ns, arg)
+            elif kind == "wake":
+                start = blocked_since.pop(resource, None)
+                if start is not None:
+                    events.append({"ph": "X", "name": f"blocked on {res}", "cat": "block",
+                                   "pid": pid, "tid": tid, "ts": us(start[0]),
+                                   "dur": (ns - start[0]) / 1000.0, "args": {"seq": arg}})
+            else:
+                # 1 ns slices, so flow arrows have something to bind to.
+                events.append({"ph": "X", "name": kind, "cat": "handoff", "pid": pid, "tid": tid,
+                               "ts": us(ns), "dur": 0.001, "args": {"seq": arg}})
+                if flows:
+                    flow = {"ph": "s" if kind == "enqueue" else "f", "name": "message",
+                            "cat": "handoff", "id": arg, "pid": pid, "tid": tid, "ts": us(ns)}
+                    if kind == "dequeue":
+                        flow["bp"] = "e"
+                    events.append(flow)
+
+    return {"traceEvents": events, "displayTimeUnit": "ns"}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("inputs", nargs="+", help="trace_*.bin files or directories holding them")
+    parser.add_argument("-o", "--output", default="trace.json", help="output JSON file (default: trace.json)")
+    parser.add_argument("--no-flows", action="store_true", help="do not draw enqueue -> dequeue arrows")
+    args = parser.parse_args()
+
+    paths = []
+    for item in args.inputs:
+        if os.path.isdir(item):
+            paths.extend(sorted(glob.glob(os.path.join(item, "trace_*.bin"))))
+        else:
+            paths.append(item)
+    if not paths:
+        parser.error("no trace files found")
+
+    traces = [read_trace(p) for p in paths]
+    with open(args.output, "w") as f:
+        json.dump(convert(traces, not args.no_flows), f)
+    total = sum(len(t["records"]) for t in traces)
+    print(f">> {total} records from {len(traces)} threads written to {args.output}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,265 @@
+#define _GNU_SOURCE // memfd_create, MFD_HUGETLB, MAP_POPULATE
+#include <sys/mman.h>
+#include <sys/resource.h> // getrusage
+#include <fcntl.h>     // O_* constants
+#include <sys/stat.h>  // mode_t and permission constants
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>     // printf
+#include <stdlib.h>    // macros
+#include <string.h>
+#include <time.h>
+#include <unistd.h>    // close, ftruncate, getopt
+
+// --- Shared-memory mapping benchmark ---
+// What it costs to get a shared segment ready for use, phase by phase,
+// for each way of creating one:
+//
+//   shm        shm_open + ftruncate + mmap(MAP_SHARED)  (the IPC app's way)
+//   memfd      memfd_create + ftruncate + mmap(MAP_SHARED)
+//   anon       mmap(MAP_SHARED|MAP_ANONYMOUS), inherited over fork
+//   populate   shm, with MAP_POPULATE: faults taken inside mmap()
+//   thp        anon, with madvise(MADV_HUGEPAGE); skipped when
+//              /sys/kernel/mm/transparent_hugepage/shmem_enabled is never
+//              or deny (the rows would be plain 4 KB anon), and for sizes
+//              below one 2 MB huge page
+//   hugetlb    memfd_create(MFD_HUGETLB): 2 MB pages from the reserved
+//              pool (vm.nr_hugepages), size rounded up to whole huge pages
+//
+//   ./mapping_bench [-s strategy,...] [-z min_size] [-Z max_size] [-f factor] [-n iterations]
+//
+// Defaults: every strategy, 4K to 1G in steps of x4, 5 iterations. Sizes
+// take a K, M or G suffix.
+//
+// Phases: create (shm_open / memfd_create), size (ftruncate), map (mmap,
+// plus madvise), touch (first write to every page: the page faults),
+// write (memset of the now resident segment), unmap (munmap, close and
+// shm_unlink). Output, one line per strategy and size, averaged over the
+// iterations:
+//   strategy,size_bytes,pages,create_ns,size_ns,map_ns,touch_ns,unmap_ns,
+//   total_ns,faults,touch_ns_per_page,total_ns_per_page,first_touch_MBps,write_MBps
+// total_ns is every phase but write, faults are minor + major faults per
+// iteration, pages are in the page size the strategy touches with (4 KB,
+// or 2 MB for hugetlb).
+
+#define SHARE_MEMORY_NAME "/mapping_bench"
+#define HUGE_PAGE_SIZE (2UL << 20)
+#define THP_SHMEM_ENABLED "/sys/kernel/mm/transparent_hugepage/shmem_enabled"
+
+enum { STRATEGY_SHM, STRATEGY_MEMFD, STRATEGY_ANON, STRATEGY_POPULATE, STRATEGY_THP, STRATEGY_HUGETLB, STRATEGIES };
+static const char *strategy_names[STRATEGIES] = { "shm", "memfd", "anon", "populate", "thp", "hugetlb" };
+
+typedef struct {
+    uint64_t create_ns, size_ns, map_ns, touch_ns, write_ns, unmap_ns;
+    uint64_t faults;
+} phase_times;
+
+
+static uint64_t monotonic_ns(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static uint64_t page_faults(void){
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return (uint64_t)usage.ru_minflt + (uint64_t)usage.ru_majflt;
+}
+
+// "4K", "16M", "1G" or plain bytes.
+static size_t parse_size(const char *text){
+    char *end;
+    double value = strtod(text, &end);
+    switch(*end){
+        case 'k': case 'K': value *= 1024; break;
+        case 'm': case 'M': value *= 1024 * 1024; break;
+        case 'g': case 'G': value *= 1024 * 1024 * 1024; break;
+    }
+    return (size_t)value;
+}
+
+// One create -> size -> map -> touch -> write -> unmap cycle; -1 if the
+// strategy is not available here.
+static int run_once(int strategy, size_t size, size_t page, phase_times *t){
+    int fd = -1;
+    uint64_t faults_start = page_faults();
+
+    uint64_t t0 = monotonic_ns();
+    if(strategy == STRATEGY_SHM || strategy == STRATEGY_POPULATE){
+        fd = shm_open(SHARE_MEMORY_NAME, O_RDWR|O_CREAT|O_EXCL, 0600);
+    }else if(strategy == STRATEGY_MEMFD){
+        fd = memfd_create("mapping_bench", MFD_CLOEXEC);
+    }else if(strategy == STRATEGY_HUGETLB){
+        fd = memfd_create("mapping_bench", MFD_CLOEXEC|MFD_HUGETLB);
+    }
+    uint64_t t1 = monotonic_ns();
+    if(fd == -1 && strategy != STRATEGY_ANON && strategy != STRATEGY_THP){
+        perror("shm_open/memfd_create failed.");
+        return -1;
+    }
+
+    if(fd != -1 && ftruncate(fd, size) == -1){
+        perror("ftruncate() failed.");
+        close(fd);
+        return -1;
+    }
+    uint64_t t2 = monotonic_ns();
+
+    int flags = MAP_SHARED;
+    if(fd == -1) flags |= MAP_ANONYMOUS;
+    if(strategy == STRATEGY_POPULATE) flags |= MAP_POPULATE;
+    char *buffer = mmap(NULL, size, PROT_READ|PROT_WRITE, flags, fd, 0);
+    if(buffer == MAP_FAILED){
+        int saved = errno;
+        perror("mmap() failed.");
+        if(fd != -1) close(fd);
+        if(strategy == STRATEGY_SHM || strategy == STRATEGY_POPULATE) shm_unlink(SHARE_MEMORY_NAME);
+        errno = saved;
+        return -1;
+    }
+    if(strategy == STRATEGY_THP && madvise(buffer, size, MADV_HUGEPAGE) == -1){
+        perror("madvise(MADV_HUGEPAGE) failed.");
+    }
+    uint64_t t3 = monotonic_ns();
+
+    // first touch: one write per page.
+    for(size_t offset = 0; offset < size; offset += page){
+        ((volatile char *)buffer)[offset] = 1;
+    }
+    uint64_t t4 = monotonic_ns();
+
+    memset(buffer, 'A', size);
+    __asm__ __volatile__("" : : "r"(buffer) : "memory");
+    uint64_t t5 = monotonic_ns();
+
+    if(munmap(buffer, size) == -1){
+        perror("munmap() failed.");
+        return -1;
+    }
+    if(fd != -1) close(fd);
+    if(strategy == STRATEGY_SHM || strategy == STRATEGY_POPULATE){
+        if(shm_unlink(SHARE_MEMORY_NAME) == -1){
+            perror("shm_unlink failed.");
+            return -1;
+        }
+    }
+    uint64_t t6 = monotonic_ns();
+
+    t->create_ns += t1 - t0;
+    t->size_ns += t2 - t1;
+    t->map_ns += t3 - t2;
+    t->touch_ns += t4 - t3;
+    t->write_ns += t5 - t4;
+    t->unmap_ns += t6 - t5;
+    t->faults += page_faults() - faults_start;
+    return 0;
+}
+
+// 0 if shared memory THP is off (or the kernel has none): MADV_HUGEPAGE
+// would be ignored and the thp rows would measure 4 KB pages.
+static int thp_available(void){
+    char mode[128] = "";
+    FILE *f = fopen(THP_SHMEM_ENABLED, "r");
+    if(f == NULL){
+        fprintf(stderr, "thp: no %s, skipped\n", THP_SHMEM_ENABLED);
+        return 0;
+    }
+    if(fgets(mode, sizeof(mode), f) == NULL) mode[0] = '\0';
+    fclose(f);
+    if(strstr(mode, "[never]") || strstr(mode, "[deny]")){
+        fprintf(stderr, "thp: shared memory THP is off (%s), skipped\n", THP_SHMEM_ENABLED);
+        return 0;
+    }
+    return 1;
+}
+
+
+int main(int argc, char *argv[])
+{
+    int enabled[STRATEGIES] = { 1, 1, 1, 1, 1, 1 };
+    size_t min_size = 4096;
+    size_t max_size = 1UL << 30;
+    size_t factor = 4;
+    int iterations = 5;
+
+    int opt;
+    while((opt = getopt(argc, argv, "s:z:Z:f:n:")) != -1){
+        switch(opt){
+            case 's': {
+                memset(enabled, 0, sizeof(enabled));
+                char *list = strdup(optarg);
+                for(char *name = strtok(list, ","); name != NULL; name = strtok(NULL, ",")){
+                    int found = 0;
+                    for(int s = 0; s < STRATEGIES; s++){
+                        if(strcmp(name, strategy_names[s]) == 0){
+                            enabled[s] = found = 1;
+                        }
+                    }
+                    if(!found){
+                        fprintf(stderr, "unknown strategy \"%s\" (shm, memfd, anon, populate, thp, hugetlb)\n", name);
+                        return EXIT_FAILURE;
+                    }
+                }
+                free(list);
+                break;
+            }
+            case 'z': min_size = parse_size(optarg); break;
+            case 'Z': max_size = parse_size(optarg); break;
+            case 'f': factor = (size_t)atoi(optarg); break;
+            case 'n': iterations = atoi(optarg); break;
+            default:
+                fprintf(stderr, "usage: %s [-s strategy,...] [-z min_size] [-Z max_size] [-f factor] [-n iterations]\n", argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    size_t small_page = (size_t)sysconf(_SC_PAGESIZE);
+    if(min_size < small_page || max_size < min_size || factor < 2 || iterations < 1){
+        fprintf(stderr, "need %zu <= min_size <= max_size, factor >= 2, iterations >= 1\n", small_page);
+        return EXIT_FAILURE;
+    }
+    // a leftover from an interrupted run would make O_EXCL fail.
+    shm_unlink(SHARE_MEMORY_NAME);
+
+    for(int s = 0; s < STRATEGIES; s++){
+        if(!enabled[s]) continue;
+        if(s == STRATEGY_THP && !thp_available()) continue;
+        size_t page = s == STRATEGY_HUGETLB ? HUGE_PAGE_SIZE : small_page;
+
+        for(size_t requested = min_size; requested <= max_size; requested *= factor){
+            size_t size = (requested + page - 1) / page * page;
+            // no huge page fits: the same 4 KB mapping as anon.
+            if(s == STRATEGY_THP && size < HUGE_PAGE_SIZE) continue;
+            phase_times t = { 0 };
+
+            // one untimed round so the first size does not pay for
+            // first-use costs (page tables, library paths).
+            phase_times warmup = { 0 };
+            if(run_once(s, size, page, &warmup) == -1){
+                if(s == STRATEGY_HUGETLB && errno == ENOMEM){
+                    fprintf(stderr, "hugetlb: no free huge pages for %zu bytes (see vm.nr_hugepages)\n", size);
+                }
+                break;
+            }
+            int ok = 1;
+            for(int i = 0; i < iterations && ok; i++){
+                ok = run_once(s, size, page, &t) == 0;
+            }
+            if(!ok) break;
+
+            size_t pages = size / page;
+            double n = iterations;
+            uint64_t total = t.create_ns + t.size_ns + t.map_ns + t.touch_ns + t.unmap_ns;
+            printf("%s,%zu,%zu,%.0f,%.0f,%.0f,%.0f,%.0f,%.0f,%.0f,%.1f,%.1f,%.1f,%.1f\n",
+                   strategy_names[s], size, pages,
+                   t.create_ns / n, t.size_ns / n, t.map_ns / n, t.touch_ns / n, t.unmap_ns / n,
+                   total / n, t.faults / n,
+                   t.touch_ns / n / pages, total / n / pages,
+                   // populate pays for its faults in map, count them in.
+                   size * n / (s == STRATEGY_POPULATE ? t.map_ns + t.touch_ns : t.touch_ns) * 1e3,
+                   size * n / t.write_ns * 1e3);
+            fflush(stdout);
+        }
+    }
+    return EXIT_SUCCESS;
+}
@@ -1,5 +1,28 @@
+#ifndef COMMON_H
+#define COMMON_H
+
 #include <semaphore.h>
+#include <pthread.h>
 #include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "../common/layout.h"
+#include "../common/trace.h"
+#include "../common/latency_hist.h"
+#include "../common/open_loop.h"
+#include "../common/workload.h"
+#include "../common/slab_arena.h"
+#include "../common/live_stats.h"
+#ifdef MEMFD_RENDEZVOUS
+    #include "../common/rendezvous.h"
+#endif
+#ifdef JOURNAL
+    #include "../common/journal.h"
+#endif
 
 #ifdef DEBUG
     #define LOG(msg, ...) printf(msg, ##__VA_ARGS__);
@@ -10,6 +33,39 @@
 #define READY_SEMAPHORE "/ready_semaphore"
 #define SHARE_MEMORY_NAME "/my_share_memory"
 
+// --- memfd rendezvous ---
+// With -DMEMFD_RENDEZVOUS the two names above are not used: the producer
+// puts the segment in an anonymous memfd and hands it to the consumer with
+// SCM_RIGHTS over the socket named by $IPC_CHANNEL (see
+// ../common/rendezvous.h). Neither side polls, and pairs on different
+// channels can start side by side. The consumer prints "attach_ns,<ns>",
+// the time from the producer's send to a mapped segment.
+#define CHANNEL_ENV "IPC_CHANNEL"
+#define DEFAULT_CHANNEL "default"
+
+typedef struct{
+    uint64_t sent_ns;       // CLOCK_MONOTONIC just before sendmsg()
+    uint64_t segment_size;  // SHM_SIZE of the producer build
+}channel_hello;
+
+// --- Launcher ---
+// launcher.c builds the segment itself and forks (or, with -e, forks and
+// execs) producer and consumer. Exec'd children find the segment in the
+// inherited descriptor named by $IPC_SEGMENT_FD and the number of rounds
+// in $IPC_LAUNCH_RUNS.
+#define SEGMENT_FD_ENV "IPC_SEGMENT_FD"
+#define LAUNCH_RUNS_ENV "IPC_LAUNCH_RUNS"
+
+typedef struct{
+    uint64_t start_ns;      // CLOCK_MONOTONIC when the side left the barrier
+    uint64_t end_ns;        // ... and when its loop returned
+}side_stats;
+
+static inline const char *channel_name(void){
+    const char *name = getenv(CHANNEL_ENV);
+    return (name && *name) ? name : DEFAULT_CHANNEL;
+}
+
 // --- Workload setting ---
 #ifndef NUM_PRODUCTS
     #define NUM_PRODUCTS 100000
@@ -23,23 +79,364 @@
     #define MAX_MESSAGE_LEN 1024
 #endif
 
+// --- Out-of-band payloads ---
+// With -DSLAB_ARENA the payload goes into a block from a slab arena in the
+// segment (../common/slab_arena.h) and a ring slot only carries its
+// payload_desc, so the ring stays a few cache lines whatever
+// MAX_MESSAGE_LEN is. The producer fills the block before it waits for
+// space; the consumer frees it before posting space, so at most
+// BUFFER_SIZE + 1 blocks are ever live.
+typedef struct{
+    uint64_t handle;        // arena handle, valid in every process
+    uint32_t length;
+    uint32_t reserved;
+}payload_desc;
+
+// --- Journal ---
+// With -DJOURNAL the payload is appended to a file-backed segmented log
+// (../common/journal.h) at $IPC_JOURNAL (default "ipc_journal.<n>") and a
+// ring slot only carries its journal_ref. The log outlives shm_unlink():
+// ./replay can rejoin it at any record, also while the producer is still
+// streaming. Pick the durability policy with -DJOURNAL_SYNC_POLICY and
+// -DJOURNAL_SYNC_INTERVAL.
+#define JOURNAL_ENV "IPC_JOURNAL"
+#define DEFAULT_JOURNAL "ipc_journal"
+
+static inline const char *journal_name(void){
+    const char *name = getenv(JOURNAL_ENV);
+    return (name && *name) ? name : DEFAULT_JOURNAL;
+}
+
+#if defined(JOURNAL) && defined(SLAB_ARENA)
+    #error "JOURNAL and SLAB_ARENA both move the payload out of the ring; pick one."
+#endif
+
+#ifdef SLAB_ARENA
+    #define SLOT_BYTES ((int)sizeof(payload_desc))
+    #ifndef ARENA_SIZE
+        // BUFFER_SIZE + 1 live blocks, each at most twice the message
+        // (power-of-two classes), plus the header.
+        #define ARENA_SIZE ((size_t)(BUFFER_SIZE + 2) * 2 * ((MAX_MESSAGE_LEN) + ARENA_ALIGN) + ARENA_DATA_START)
+    #endif
+#elif defined(JOURNAL)
+    #define SLOT_BYTES ((int)sizeof(journal_ref))
+#else
+    #define SLOT_BYTES MAX_MESSAGE_LEN
+#endif
+
+// slots padded to whole cache lines under -DPADDED_LAYOUT (../common/layout.h).
+#define SLOT_LEN LAYOUT_SLOT_LEN(SLOT_BYTES)
+
+// non-temporal copy and prefetch for large messages (needs MAX_MESSAGE_LEN).
+#include "../common/stream_copy.h"
+
+// --- Adaptive buffer ---
+// With -DADAPTIVE_BUFFER, BUFFER_SIZE is only the preallocated maximum. The
+// producer retunes the active capacity (space tokens in circulation) at run
+// time and keeps in-flight messages inside the first `capacity` slots, so a
+// single binary settles on a buffer size per workload. See producer.c.
+#ifndef TUNE_INTERVAL
+    #define TUNE_INTERVAL 1024          // messages between tuning decisions
+#endif
+#ifndef TUNE_INITIAL_CAPACITY
+    #define TUNE_INITIAL_CAPACITY 1
+#endif
+#ifndef TUNE_FULL_THRESHOLD
+    #define TUNE_FULL_THRESHOLD 0.05    // grow if the producer blocks on >5% of sends
+#endif
+#ifndef TUNE_TOLERANCE
+    #define TUNE_TOLERANCE 0.02         // a grow must buy >2% throughput to stick
+#endif
+#ifndef TUNE_TARGET_DELAY_US
+    #define TUNE_TARGET_DELAY_US 0      // >0: cap the estimated queueing delay
+#endif
+#ifndef TUNE_REPROBE_INTERVALS
+    #define TUNE_REPROBE_INTERVALS 32   // intervals before a capped size is re-probed
+#endif
+#ifndef TUNE_LOG_FILE
+    #define TUNE_LOG_FILE "capacity_trajectory.csv"
+#endif
+
+// --- Open loop ---
+// -DOPEN_LOOP paces the producer at TARGET_RATE (see ../common/open_loop.h)
+// and the consumer records per-message latency into data_ptr->latency.
+#ifdef OPEN_LOOP
+_Static_assert(MAX_MESSAGE_LEN >= SEND_STAMP_LEN, "OPEN_LOOP needs room for the send stamp");
+#endif
+
+// --- Live stats ---
+// -DLIVE_STATS publishes this channel's counters and latency histogram to
+// LIVE_STATS_PREFIX$IPC_CHANNEL (see ../common/live_stats.h) for monitor.c.
+// Without OPEN_LOOP the producer stamps every message with its send time
+// so the consumer can measure latency.
+#ifdef LIVE_STATS
+_Static_assert(MAX_MESSAGE_LEN >= SEND_STAMP_LEN, "LIVE_STATS needs room for the send stamp");
+#endif
+#define CHANNEL_STATS_OPEN(side) STATS_OPEN(channel_name(), (side), MAX_MESSAGE_LEN, BUFFER_SIZE)
+
 
 typedef struct{
-    sem_t semaphore;
-    sem_t product;
-    sem_t space;
+    sem_t semaphore CACHE_ALIGNED;
+    sem_t product CACHE_ALIGNED;    // posted by producer, waited by consumer
+    sem_t space CACHE_ALIGNED;      // posted by consumer, waited by producer
     sem_t complete;
+    int failed;                         // a side gave up mid-run, see consumer()
 
     // shared data
-    char message[BUFFER_SIZE][MAX_MESSAGE_LEN];
-    int curr_producer, curr_consumer;
+    char message[BUFFER_SIZE][SLOT_LEN] CACHE_ALIGNED;
+    int curr_producer CACHE_ALIGNED;    // producer-side hot state
+    int curr_consumer CACHE_ALIGNED;    // consumer-side hot state
+
+#ifdef ADAPTIVE_BUFFER
+    int capacity CACHE_ALIGNED;         // active slots, <= BUFFER_SIZE
+    int slot_hint;                      // next slot the producer tries
+    int slot_order[BUFFER_SIZE];        // FIFO of written slot numbers
+    char slot_busy[BUFFER_SIZE];        // slot holds an unread message
+    unsigned long consumer_blocks CACHE_ALIGNED;
+#endif
+
+#ifdef OPEN_LOOP
+    latency_hist latency CACHE_ALIGNED; // written by the consumer only
+#endif
+
+#ifdef SLAB_ARENA
+    char arena[ARENA_SIZE] __attribute__((aligned(ARENA_ALIGN)));
+#endif
 
 
     /* --- For time measurement --- */
-    sem_t consumer_ready;
+    sem_t consumer_ready CACHE_ALIGNED;
     sem_t start_gun_sem; 
 
+    /* --- launcher.c only --- */
+    pthread_barrier_t launch_barrier CACHE_ALIGNED;
+    sem_t launch_ready;                 // posted by each side once set up
+    side_stats producer_stats CACHE_ALIGNED;
+    side_stats consumer_stats CACHE_ALIGNED;
+
 }shared_data;
 
 // get the size of shared_data struct.
 #define SHM_SIZE sizeof(shared_data)
+
+#define ARENA(data_ptr) ((arena_header *)(data_ptr)->arena)
+
+
+// Ring indices, semaphores and per-run state to their start values. The
+// producer calls it once; launcher.c calls it again between rounds, while
+// both sides are parked on launch_barrier.
+static inline int init_shared_data(shared_data *data_ptr){
+    // --- Initialize circular buffer index ---
+    data_ptr->curr_producer = 0;
+    data_ptr->curr_consumer = 0;
+    data_ptr->failed = 0;
+
+    #ifdef ADAPTIVE_BUFFER
+    data_ptr->capacity = TUNE_INITIAL_CAPACITY;
+    data_ptr->slot_hint = 0;
+    data_ptr->consumer_blocks = 0;
+    memset(data_ptr->slot_busy, 0, sizeof(data_ptr->slot_busy));
+    #endif
+
+    #ifdef OPEN_LOOP
+    hist_reset(&data_ptr->latency);
+    #endif
+
+    #ifdef SLAB_ARENA
+    arena_init(ARENA(data_ptr), ARENA_SIZE);
+    #endif
+
+    // --- Initialize semaphore ---
+    if(sem_init(&data_ptr->semaphore, 1, 1) == -1 ||
+       #ifdef ADAPTIVE_BUFFER
+       sem_init(&data_ptr->space, 1, TUNE_INITIAL_CAPACITY) == -1 ||
+       #else
+       sem_init(&data_ptr->space, 1, BUFFER_SIZE) == -1 ||
+       #endif
+       sem_init(&data_ptr->product, 1, 0) == -1||
+       sem_init(&data_ptr->complete, 1, 0)== -1){
+        perror("sem_init failed.");
+        return -1;
+    }
+
+    // --- For time measurement ---
+    sem_init(&data_ptr->consumer_ready, 1, 0); 
+    sem_init(&data_ptr->start_gun_sem, 1, 0); 
+    return 0;
+}
+
+static inline int destroy_shared_data(shared_data *data_ptr){
+    if(sem_destroy(&data_ptr->semaphore) == -1||
+    sem_destroy(&data_ptr->space) == -1 ||
+    sem_destroy(&data_ptr->product) == -1 ||
+    sem_destroy(&data_ptr->complete) == -1){
+        perror("sem_destroy failed.");
+        return -1;
+    }
+    
+    // --- Destroy sem use for time measurement ---
+    sem_destroy(&data_ptr->consumer_ready); 
+    sem_destroy(&data_ptr->start_gun_sem); 
+    return 0;
+}
+
+// 1 and the mapped segment when exec'd by launcher.c, 0 when started on
+// our own, -1 on error.
+static inline int launched_segment(shared_data **data_ptr, int *runs){
+    const char *fd_text = getenv(SEGMENT_FD_ENV);
+    if(fd_text == NULL){
+        return 0;
+    }
+    const char *runs_text = getenv(LAUNCH_RUNS_ENV);
+    *runs = runs_text ? atoi(runs_text) : 1;
+
+    void *buffer = mmap(NULL, SHM_SIZE, PROT_READ|PROT_WRITE, MAP_SHARED, atoi(fd_text), 0);
+    if(buffer == MAP_FAILED){
+        perror("mmap(IPC_SEGMENT_FD) failed.");
+        return -1;
+    }
+    close(atoi(fd_text));
+    *data_ptr = (shared_data*)buffer;
+    return 1;
+}
+
+#ifdef OPEN_LOOP
+    #define OPEN_LOOP_LATENCY(data_ptr) (&(data_ptr)->latency)
+#else
+    #define OPEN_LOOP_LATENCY(data_ptr) NULL
+#endif
+
+// The result line every IPC entry point prints: init,comm (seconds), and
+// under OPEN_LOOP offered_rate,achieved_rate,mean,p50,p90,p99,p99.9,max (ns).
+static inline void print_result(double initialize_time, double communication_time, const latency_hist *latency){
+    #ifdef OPEN_LOOP
+    printf("%.9f,%.9f,%d,%.0f",initialize_time,communication_time,
+           TARGET_RATE, NUM_PRODUCTS / communication_time);
+    hist_print_csv(latency);
+    printf("\n");
+    #else
+    (void)latency;
+    printf("%.9f,%.9f\n",initialize_time,communication_time);
+    #endif
+}
+
+
+// --- Ring slot mapping ---
+// curr_producer/curr_consumer are ring positions. Normally a position is
+// also the slot number; in ADAPTIVE_BUFFER mode slot_order[] maps it to the
+// slot the producer picked. All three helpers run under data_ptr->semaphore.
+static inline int producer_claim_slot(shared_data *data_ptr){
+#ifdef ADAPTIVE_BUFFER
+    int cap = data_ptr->capacity;
+    int slot = data_ptr->slot_hint;
+    // prefer free slots inside the active capacity, then any free slot
+    // (slots beyond it can still be in flight right after a shrink).
+    for(int k = 0; k < BUFFER_SIZE; k++){
+        slot = k < cap ? (data_ptr->slot_hint + k) % cap : k;
+        if(!data_ptr->slot_busy[slot]) break;
+    }
+    data_ptr->slot_busy[slot] = 1;
+    data_ptr->slot_order[data_ptr->curr_producer] = slot;
+    data_ptr->slot_hint = (slot + 1) % cap;
+    return slot;
+#else
+    return data_ptr->curr_producer;
+#endif
+}
+
+static inline int consumer_slot(shared_data *data_ptr, int position){
+#ifdef ADAPTIVE_BUFFER
+    return data_ptr->slot_order[position];
+#else
+    (void)data_ptr;
+    return position;
+#endif
+}
+
+static inline void consumer_release_slot(shared_data *data_ptr, int slot){
+#ifdef ADAPTIVE_BUFFER
+    data_ptr->slot_busy[slot] = 0;
+#else
+    (void)data_ptr;
+    (void)slot;
+#endif
+}
+
+#ifdef JOURNAL
+// This process's read-only view of the journal, mapped segment by segment.
+static journal_reader ring_journal;
+#endif
+
+// Consumer setup for slot_payload(): under JOURNAL, check the journal path
+// and map the first segment now, so the first message does not pay for
+// open+mmap under the ring lock. The producer creates the journal before
+// it hands out the segment; a segment that is not there yet is mapped on
+// first use.
+static inline int payload_open(void){
+#ifdef JOURNAL
+    if(journal_reader_init(&ring_journal, journal_name()) == -1){
+        return -1;
+    }
+    journal_segment(&ring_journal, 0);
+#endif
+    return 0;
+}
+
+// Where the message in `slot` lives: the slot itself, under SLAB_ARENA the
+// arena block its descriptor points to, under JOURNAL the journal record
+// (NULL if its segment cannot be mapped).
+static inline const char *slot_payload(shared_data *data_ptr, int slot){
+#ifdef SLAB_ARENA
+    payload_desc desc;
+    memcpy(&desc, data_ptr->message[slot], sizeof(desc));
+    return arena_ptr(ARENA(data_ptr), desc.handle);
+#elif defined(JOURNAL)
+    journal_ref ref;
+    memcpy(&ref, data_ptr->message[slot], sizeof(ref));
+    return journal_payload(&ring_journal, ref);
+#else
+    return data_ptr->message[slot];
+#endif
+}
+
+// Hand the payload block back to the arena once the consumer is done.
+static inline void release_payload(shared_data *data_ptr, int slot){
+#ifdef SLAB_ARENA
+    payload_desc desc;
+    memcpy(&desc, data_ptr->message[slot], sizeof(desc));
+    arena_free(ARENA(data_ptr), desc.handle);
+#else
+    (void)data_ptr;
+    (void)slot;
+#endif
+}
+
+// sem_wait() that notices when the caller really has to sleep: it counts
+// the block into *blocks (may be NULL) for the ADAPTIVE_BUFFER tuner and
+// into the live stats, and emits block/wake trace events under -DTRACE.
+// Otherwise a plain sem_wait().
+static inline int ring_sem_wait(sem_t *sem, unsigned long *blocks, int resource, uint64_t seq){
+    // only read under -DTRACE.
+    (void)resource;
+    (void)seq;
+#if defined(ADAPTIVE_BUFFER) || defined(TRACE) || defined(LIVE_STATS)
+    if(sem_trywait(sem) == 0) return 0;
+    if(blocks) __atomic_fetch_add(blocks, 1, __ATOMIC_RELAXED);
+    STATS_BLOCK();
+    TRACE_EVENT(TRACE_BLOCK, resource, seq);
+    int r = sem_wait(sem);
+    TRACE_EVENT(TRACE_WAKE, resource, seq);
+    return r;
+#else
+    (void)blocks;
+    return sem_wait(sem);
+#endif
+}
+
+#ifdef ADAPTIVE_BUFFER
+    #define CONSUMER_BLOCKS(data_ptr) (&(data_ptr)->consumer_blocks)
+#else
+    #define CONSUMER_BLOCKS(data_ptr) NULL
+#endif
+
+#endif
@@ -1,3 +1,4 @@
+#define _GNU_SOURCE // accept4, SOCK_CLOEXEC, syscall
 #include <sys/mman.h>
 #include <fcntl.h>     // O_* constants
 #include <sys/stat.h>  // mode_t and permission constants
@@ -8,55 +9,64 @@
 #include <semaphore.h>
 #include <errno.h>
 #include "common.h"
-
-static volatile uint64_t final_checksum;
-
-void consumer(shared_data *data_ptr){
-
-    for(int i = 0;i<NUM_PRODUCTS;i++){
-        // look for a product.
-        if(sem_wait(&data_ptr->product) == -1){
-            perror("sem_wait(&data_ptr->product).");
-            break;
-        }
-        // protect read/write critical region
-        if(sem_wait(&data_ptr->semaphore) == -1){
-            perror("sem_wait(&data_ptr->semaphore).");
-            break;
-        }
-
-        // Read and print data from shared memory
-        LOG("Consume:%s\n", data_ptr->message[data_ptr->curr_consumer]);
-
-        uint64_t total_checksum = 0;
-        for (int j = 0; j < MAX_MESSAGE_LEN; j++) {
-            total_checksum += data_ptr->message[data_ptr->curr_consumer][j];
-        }
-        final_checksum = total_checksum;
-
-
-        data_ptr->curr_consumer = (data_ptr->curr_consumer + 1) % BUFFER_SIZE;
+#include "consumer.h"
+
+#ifdef MEMFD_RENDEZVOUS
+// Block until the producer on our channel hands over the segment.
+static int attach_segment(channel_hello *hello){
+    int sock = rendezvous_connect(channel_name());
+    if(sock == -1){
+        return -1;
+    }
+    int file_descriptor = -1;
+    int count = recv_fds(sock, &file_descriptor, 1, hello, sizeof(*hello));
+    close(sock);
+    if(count != 1){
+        if(count > 0) close(file_descriptor);
+        fprintf(stderr, "attach_segment: no segment received.\n");
+        return -1;
+    }
+    if(hello->segment_size != SHM_SIZE){
+        fprintf(stderr, "attach_segment: segment is %llu bytes, expected %zu (build mismatch).\n",
+                (unsigned long long)hello->segment_size, (size_t)SHM_SIZE);
+        close(file_descriptor);
+        return -1;
+    }
+    return file_descriptor;
+}
+#endif
 
 
-        if(sem_post(&data_ptr->semaphore) == -1){
-            perror("em_post(&data_ptr->semaphore)");
-            break;
-        }
+int main()
+{   
+    if(consumer_prepare() == -1){
+        return EXIT_FAILURE;
+    }
 
-        if(sem_post(&data_ptr->space) == -1){
-            perror("sem_post(&data_ptr->space)");
-            break;
+    // exec'd by launcher.c: the segment is already set up.
+    shared_data *launched;
+    int runs;
+    int launched_mode = launched_segment(&launched, &runs);
+    if(launched_mode != 0){
+        if(launched_mode == -1 || launched_consumer(launched, runs) == -1){
+            return EXIT_FAILURE;
         }
-    
-    }    
-    sem_post(&data_ptr->complete);
-
-
-}
+        return EXIT_SUCCESS;
+    }
 
+    // the trace ring and the stats segment are mapped (and the ring
+    // pre-faulted) before we wait for the producer, so they stay out of
+    // its initialize_time. A failure is reported once we are attached.
+    int opened = TRACE_OPEN("consumer") == -1 || CHANNEL_STATS_OPEN(STATS_CONSUMER) == -1 ? -1 : 0;
 
-int main()
-{   
+    #ifdef MEMFD_RENDEZVOUS
+    channel_hello hello;
+    int file_descriptor = attach_segment(&hello);
+    if(file_descriptor == -1)
+    {
+        return EXIT_FAILURE;
+    }
+    #else
     sem_t * ready;
     for(;;)
     {
@@ -79,6 +89,7 @@ int main()
         return EXIT_FAILURE;
     }
     LOG("shm_open() success.\n");
+    #endif
     
 
     // map shared memory object to virtual memory.
@@ -90,16 +101,30 @@ int main()
     LOG("mmap() success.\n");
     close(file_descriptor);
 
+    #ifdef MEMFD_RENDEZVOUS
+    printf("attach_ns,%llu\n", (unsigned long long)(monotonic_ns() - hello.sent_ns));
+    #endif
+
 
     // --- Initialize semaphore ---
     shared_data *data_ptr = (shared_data*)buffer;
 
+    if(opened == -1 || payload_open() == -1){
+        // the producer is waiting for us: tell it the run is off.
+        data_ptr->failed = 1;
+        sem_post(&data_ptr->consumer_ready);
+        return EXIT_FAILURE;
+    }
+
     // --- For time Measurement ---
     sem_post(&data_ptr->consumer_ready);
     sem_wait(&data_ptr->start_gun_sem);
 
     // --- Read from/write to the shared memory buffer ---
     consumer(data_ptr);
+    TRACE_CLOSE();
+    STATS_CLOSE();
+    int failed = data_ptr->failed;
 
     
     // unmap shared memory object from virtual memory.s
@@ -110,5 +135,5 @@ int main()
     LOG("munmap() success.\n");
 
 
-    return EXIT_SUCCESS;
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
 }
\ No newline at end of file
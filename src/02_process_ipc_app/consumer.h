@@ -0,0 +1,116 @@
+#ifndef CONSUMER_H
+#define CONSUMER_H
+
+// --- Consumer side ---
+// The consumer loop and its per-process state. Included by consumer.c and
+// by launcher.c, which runs the same loop in a forked child.
+
+#include <stdio.h>
+#include <pthread.h>
+#include "common.h"
+
+static volatile uint64_t final_checksum;
+static workload consumer_work;
+
+static void consumer(shared_data *data_ptr){
+
+    for(int i = 0;i<NUM_PRODUCTS;i++){
+        // look for a product.
+        if(ring_sem_wait(&data_ptr->product, CONSUMER_BLOCKS(data_ptr), TRACE_RES_PRODUCT, i) == -1){
+            perror("sem_wait(&data_ptr->product).");
+            break;
+        }
+        // protect read/write critical region
+        if(ring_sem_wait(&data_ptr->semaphore, NULL, TRACE_RES_LOCK, i) == -1){
+            perror("sem_wait(&data_ptr->semaphore).");
+            break;
+        }
+
+        int slot = consumer_slot(data_ptr, data_ptr->curr_consumer);
+        const char *message = slot_payload(data_ptr, slot);
+        if(message == NULL){
+            fprintf(stderr, "consumer: payload of message %d not reachable.\n", i);
+            // let the producer go: it sees `failed` after its next wait
+            // for space and stops.
+            __atomic_store_n(&data_ptr->failed, 1, __ATOMIC_RELEASE);
+            sem_post(&data_ptr->semaphore);
+            sem_post(&data_ptr->space);
+            break;
+        }
+
+        #if defined(OPEN_LOOP) || defined(LIVE_STATS)
+        uint64_t latency_ns = monotonic_ns() - read_send_stamp(message, MAX_MESSAGE_LEN);
+        #endif
+        #ifdef OPEN_LOOP
+        hist_record(&data_ptr->latency, latency_ns);
+        #endif
+        STATS_LATENCY(latency_ns);
+
+        // Read and print data from shared memory
+        LOG("Consume:%s\n", message);
+
+        // prefetch the next slot only if the producer has already published it.
+        const char *next = NULL;
+        int pending = 0;
+        if(USE_STREAM_COPY && sem_getvalue(&data_ptr->product, &pending) == 0 && pending > 0){
+            next = slot_payload(data_ptr, consumer_slot(data_ptr, (data_ptr->curr_consumer + 1) % BUFFER_SIZE));
+        }
+        if(consumer_work.run == workload_checksum){
+            final_checksum = checksum_message(message, next, MAX_MESSAGE_LEN);
+        }else{
+            final_checksum = consumer_work.run(&consumer_work, message, MAX_MESSAGE_LEN);
+        }
+        release_payload(data_ptr, slot);
+        consumer_release_slot(data_ptr, slot);
+
+
+        data_ptr->curr_consumer = (data_ptr->curr_consumer + 1) % BUFFER_SIZE;
+
+
+        if(sem_post(&data_ptr->semaphore) == -1){
+            perror("em_post(&data_ptr->semaphore)");
+            break;
+        }
+
+        if(sem_post(&data_ptr->space) == -1){
+            perror("sem_post(&data_ptr->space)");
+            break;
+        }
+        TRACE_EVENT(TRACE_DEQUEUE, TRACE_RES_NONE, i);
+        STATS_MESSAGE(MAX_MESSAGE_LEN);
+    
+    }    
+    sem_post(&data_ptr->complete);
+
+
+}
+
+
+// Per-process setup: the WORKLOAD selection.
+static int consumer_prepare(void){
+    return workload_from_env(&consumer_work, "WORKLOAD", "checksum");
+}
+
+// Consumer body under launcher.c, see launched_producer().
+static int launched_consumer(shared_data *data_ptr, int runs){
+    if(TRACE_OPEN("consumer") == -1 || CHANNEL_STATS_OPEN(STATS_CONSUMER) == -1 || payload_open() == -1){
+        return -1;
+    }
+    sem_post(&data_ptr->launch_ready);
+
+    for(int run = 0; run < runs; run++){
+        pthread_barrier_wait(&data_ptr->launch_barrier);
+        data_ptr->consumer_stats.start_ns = monotonic_ns();
+        consumer(data_ptr);
+        data_ptr->consumer_stats.end_ns = monotonic_ns();
+        pthread_barrier_wait(&data_ptr->launch_barrier);
+        // all three parties read `failed` after the same barrier.
+        if(data_ptr->failed) break;
+    }
+
+    TRACE_CLOSE();
+    STATS_CLOSE();
+    return data_ptr->failed ? -1 : 0;
+}
+
+#endif
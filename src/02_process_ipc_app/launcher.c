@@ -0,0 +1,254 @@
+#define _POSIX_C_SOURCE 200809L // CLOCK_MONOTONIC
+#define _GNU_SOURCE // memfd_create, syscall() used by ../common/trace.h
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <signal.h>    // kill
+#include <errno.h>
+#include <time.h>      // sem_clockwait deadline
+#include <fcntl.h>     // O_* constants
+#include <stdio.h>     // printf
+#include <stdlib.h>    // macros
+#include <unistd.h>    // fork, exec
+#include <libgen.h>    // dirname
+#include <limits.h>    // PATH_MAX
+#include <pthread.h>
+#include <semaphore.h>
+#include "common.h"
+#include "producer.h"
+#include "consumer.h"
+
+// --- Launcher ---
+// Replaces run_ipc_test.sh: builds the segment, forks the consumer and the
+// producer and lines both up on a process-shared barrier, so no shell or
+// exec start-up lands inside the measurement.
+//
+//   ./launcher [-r runs] [-e]
+//
+//   -r runs  repeat the exchange `runs` times with the same two processes;
+//            the segment is reset between rounds while both wait on the
+//            barrier. One result line per round.
+//   -e       exec ./producer and ./consumer (next to this binary) instead of
+//            running the loops in the forked children.
+//
+// Output per round is the producer's line: init,comm. init is the time from
+// launch (or from the reset, for later rounds) to the barrier, comm runs
+// from the first side leaving the barrier to the last one finishing.
+
+#define LAUNCH_PARTIES 3 // launcher, producer, consumer
+#define READY_POLL_MS 100
+
+
+// <directory of this binary>/<name>, checked up front: a child that
+// cannot exec would leave the others stuck on the barrier.
+static int side_path(char *path, size_t size, const char *name){
+    char self[PATH_MAX];
+    ssize_t len = readlink("/proc/self/exe", self, sizeof(self) - 1);
+    if(len == -1){
+        perror("readlink(/proc/self/exe) failed.");
+        return -1;
+    }
+    self[len] = '\0';
+    snprintf(path, size, "%s/%s", dirname(self), name);
+    if(access(path, X_OK) == -1){
+        perror(path);
+        return -1;
+    }
+    return 0;
+}
+
+// Fork one side. In exec mode (path != NULL) the child runs the standalone
+// binary, which picks the segment up from IPC_SEGMENT_FD.
+static pid_t spawn_side(const char *path, int (*side)(shared_data *, int), shared_data *data_ptr, int runs){
+    fflush(NULL);
+    pid_t pid = fork();
+    if(pid != 0){
+        if(pid == -1) perror("fork() failed.");
+        return pid;
+    }
+
+    if(path != NULL){
+        execl(path, path, (char *)NULL);
+        perror("execl() failed.");
+        _exit(EXIT_FAILURE);
+    }
+    exit(side(data_ptr, runs) == -1 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+
+// Wait until the side spawned last posts launch_ready, i.e. has finished
+// its setup (workload, journal, tuner log, trace ring, stats segment,
+// exec) and is about to enter the barrier. A side that exits before that
+// would leave the others and us stuck on the barrier, so the survivors
+// among the `spawned` sides are killed.
+static int wait_side_ready(shared_data *data_ptr, const pid_t *pids, const char **names, int spawned){
+    for(;;){
+        struct timespec deadline;
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        deadline.tv_nsec += READY_POLL_MS * 1000000L;
+        if(deadline.tv_nsec >= 1000000000L){
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+        if(sem_clockwait(&data_ptr->launch_ready, CLOCK_MONOTONIC, &deadline) == 0){
+            return 0;
+        }
+        if(errno != ETIMEDOUT && errno != EINTR){
+            perror("sem_clockwait(launch_ready) failed.");
+            return -1;
+        }
+        for(int i = 0; i < spawned; i++){
+            if(waitpid(pids[i], NULL, WNOHANG) != pids[i]) continue;
+            fprintf(stderr, "launcher: %s exited before the start barrier.\n", names[i]);
+            for(int j = 0; j < spawned; j++){
+                if(j == i) continue;
+                kill(pids[j], SIGKILL);
+                waitpid(pids[j], NULL, 0);
+            }
+            return -1;
+        }
+    }
+}
+
+
+int main(int argc, char *argv[])
+{
+    int runs = 1;
+    int exec_mode = 0;
+    int opt;
+    while((opt = getopt(argc, argv, "r:e")) != -1){
+        switch(opt){
+            case 'r': runs = atoi(optarg); break;
+            case 'e': exec_mode = 1; break;
+            default:
+                fprintf(stderr, "usage: %s [-r runs] [-e]\n", argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    if(runs < 1) runs = 1;
+
+    char producer_path[PATH_MAX], consumer_path[PATH_MAX];
+    if(exec_mode && (side_path(producer_path, sizeof(producer_path), "producer") == -1 ||
+                     side_path(consumer_path, sizeof(consumer_path), "consumer") == -1)){
+        return EXIT_FAILURE;
+    }
+
+    // workload calibration happens here, before the clock starts; forked
+    // children inherit the result.
+    if(!exec_mode && (producer_prepare() == -1 || consumer_prepare() == -1)){
+        return EXIT_FAILURE;
+    }
+
+    struct timespec start_time, communication_start_time;
+
+    // startup time measurement start.
+    clock_gettime(CLOCK_MONOTONIC, &start_time);
+
+    // not close-on-exec: exec'd children map it through IPC_SEGMENT_FD.
+    int file_descriptor = memfd_create("ipc_launch", 0);
+    if(file_descriptor == -1){
+        perror("memfd_create() failed.");
+        return EXIT_FAILURE;
+    }
+    if(ftruncate(file_descriptor, SHM_SIZE) < 0){
+        perror("ftruncate() failed.");
+        return EXIT_FAILURE;
+    }
+    void *buffer =  mmap(NULL, SHM_SIZE, PROT_READ|PROT_WRITE, MAP_SHARED, file_descriptor, 0);
+    if(buffer == MAP_FAILED){
+        perror("mmap() failed.");
+        return EXIT_FAILURE;
+    }
+    LOG("mmap() success.\n");
+
+    shared_data *data_ptr = (shared_data*)buffer;
+
+    pthread_barrierattr_t attr;
+    pthread_barrierattr_init(&attr);
+    pthread_barrierattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+    if(pthread_barrier_init(&data_ptr->launch_barrier, &attr, LAUNCH_PARTIES) != 0){
+        perror("pthread_barrier_init() failed.");
+        return EXIT_FAILURE;
+    }
+    pthread_barrierattr_destroy(&attr);
+
+    if(init_shared_data(data_ptr) == -1 || sem_init(&data_ptr->launch_ready, 1, 0) == -1){
+        perror("launcher setup failed.");
+        return EXIT_FAILURE;
+    }
+
+    if(exec_mode){
+        char text[32];
+        snprintf(text, sizeof(text), "%d", file_descriptor);
+        setenv(SEGMENT_FD_ENV, text, 1);
+        snprintf(text, sizeof(text), "%d", runs);
+        setenv(LAUNCH_RUNS_ENV, text, 1);
+    }
+
+    // producer first: an exec'd producer creates the journal, which the
+    // consumer maps during its own setup.
+    pid_t pids[2];
+    const char *names[2] = { "producer", "consumer" };
+    pids[0] = spawn_side(exec_mode ? producer_path : NULL, launched_producer, data_ptr, runs);
+    if(pids[0] == -1 || wait_side_ready(data_ptr, pids, names, 1) == -1){
+        return EXIT_FAILURE;
+    }
+    pids[1] = spawn_side(exec_mode ? consumer_path : NULL, launched_consumer, data_ptr, runs);
+    if(pids[1] == -1){
+        kill(pids[0], SIGKILL);
+        return EXIT_FAILURE;
+    }
+    close(file_descriptor);
+
+    if(wait_side_ready(data_ptr, pids, names, 2) == -1){
+        return EXIT_FAILURE;
+    }
+
+    for(int run = 0; run < runs; run++){
+        if(run > 0){
+            clock_gettime(CLOCK_MONOTONIC, &start_time);
+            if(destroy_shared_data(data_ptr) == -1 || init_shared_data(data_ptr) == -1){
+                break;
+            }
+        }
+
+        // go: both sides take their own start stamp on the way out.
+        pthread_barrier_wait(&data_ptr->launch_barrier);
+        clock_gettime(CLOCK_MONOTONIC, &communication_start_time);
+        // done.
+        pthread_barrier_wait(&data_ptr->launch_barrier);
+        if(data_ptr->failed){
+            break;
+        }
+
+        side_stats p = data_ptr->producer_stats, c = data_ptr->consumer_stats;
+        uint64_t first = p.start_ns < c.start_ns ? p.start_ns : c.start_ns;
+        uint64_t last = p.end_ns > c.end_ns ? p.end_ns : c.end_ns;
+
+        // --- Show measurement result ---
+        double initialize_time = get_elapsed_seconds(start_time, communication_start_time);
+        double communication_time = (last - first) / 1e9;
+        LOG("Total run time: %.9f seconds\n", initialize_time);
+        LOG("Total communication time: %.9f seconds\n", communication_time);
+        print_result(initialize_time, communication_time, OPEN_LOOP_LATENCY(data_ptr));
+        fflush(stdout);
+    }
+
+    int status, failed = 0;
+    if(waitpid(pids[1], &status, 0) == -1 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) failed = 1;
+    if(waitpid(pids[0], &status, 0) == -1 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) failed = 1;
+    if(failed){
+        fprintf(stderr, "launcher: producer or consumer failed.\n");
+    }
+
+    destroy_shared_data(data_ptr);
+    pthread_barrier_destroy(&data_ptr->launch_barrier);
+    sem_destroy(&data_ptr->launch_ready);
+
+    // unmap shared memory object from virtual memory.
+    if(munmap(buffer, SHM_SIZE) == -1){
+        perror("munmap() failed.");
+        return EXIT_FAILURE;
+    }
+    LOG("munmap() success.\n");
+
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
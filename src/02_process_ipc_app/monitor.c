@@ -0,0 +1,232 @@
+#define _GNU_SOURCE
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>     // O_* constants
+#include <dirent.h>
+#include <limits.h>    // NAME_MAX
+#include <stdio.h>     // printf
+#include <stdlib.h>    // macros
+#include <string.h>
+#include <time.h>
+#include <unistd.h>    // getopt
+#include "../common/live_stats.h"
+
+// --- Live channel monitor ---
+// Attaches read-only to every live stats segment (producers and consumers
+// built with -DLIVE_STATS, see ../common/live_stats.h) and shows what each
+// channel did over the last interval, top-style. Channels that appear
+// later are picked up on the next refresh, channels whose producer is done
+// drop out. The monitor only ever reads: the channels never wait for it.
+//
+//   ./monitor [-i interval_ms] [-n refreshes] [-b] [channel ...]
+//
+// Defaults: 1000 ms, refresh until killed, every channel. -b prints CSV
+// instead of redrawing the screen, one line per channel per refresh:
+//   elapsed_s,channel,msgs_per_s,mb_per_s,producer_blocks_per_s,
+//   consumer_blocks_per_s,occupancy,capacity,latency_p50,latency_p99,latency_p99.9 (ns)
+// Latency percentiles are over the messages received in the interval.
+
+#define SHM_DIR "/dev/shm"
+#define MONITOR_MAX_CHANNELS 64
+
+typedef struct {
+    char name[NAME_MAX + 2];            // shm name, with the leading '/'
+    const live_stats *stats;            // read-only mapping
+    live_stats last;                    // snapshot of the previous refresh
+    uint64_t last_ns;
+    int seen;                           // still in SHM_DIR this refresh
+} watched_channel;
+
+static watched_channel watched[MONITOR_MAX_CHANNELS];
+static int watched_count;
+
+static uint64_t monotonic_ns(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void sleep_ms(long ms){
+    struct timespec ts = { ms / 1000, (ms % 1000) * 1000000L };
+    while(nanosleep(&ts, &ts) == -1){}
+}
+
+static int wanted(const char *channel, char **filter, int filters){
+    if(filters == 0) return 1;
+    for(int i = 0; i < filters; i++){
+        if(strcmp(channel, filter[i]) == 0) return 1;
+    }
+    return 0;
+}
+
+// Map a segment we are not watching yet; its first snapshot becomes the
+// baseline, so it shows up from the next refresh on.
+static void watch(const char *name){
+    for(int i = 0; i < watched_count; i++){
+        if(strcmp(watched[i].name, name) == 0){
+            watched[i].seen = 1;
+            return;
+        }
+    }
+    if(watched_count == MONITOR_MAX_CHANNELS) return;
+
+    int fd = shm_open(name, O_RDONLY, 0);
+    if(fd == -1) return;
+    struct stat st;
+    const live_stats *stats = MAP_FAILED;
+    if(fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(live_stats)){
+        stats = mmap(NULL, sizeof(live_stats), PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if(stats == MAP_FAILED) return;
+    if(__atomic_load_n(&stats->magic, __ATOMIC_ACQUIRE) != LIVE_STATS_MAGIC ||
+       stats->version != LIVE_STATS_VERSION){
+        // not initialized yet, or another build: try again next refresh.
+        munmap((void *)stats, sizeof(live_stats));
+        return;
+    }
+
+    watched_channel *w = &watched[watched_count++];
+    snprintf(w->name, sizeof(w->name), "%s", name);
+    w->stats = stats;
+    stats_snapshot(stats, &w->last);
+    w->last_ns = monotonic_ns();
+    w->seen = 1;
+}
+
+// Attach to new segments in SHM_DIR and let go of the ones that are gone.
+static void rescan(char **filter, int filters){
+    for(int i = 0; i < watched_count; i++) watched[i].seen = 0;
+
+    DIR *dir = opendir(SHM_DIR);
+    if(dir == NULL){
+        perror("opendir(" SHM_DIR ") failed.");
+        exit(EXIT_FAILURE);
+    }
+    const char *prefix = LIVE_STATS_PREFIX + 1;
+    size_t prefix_len = strlen(prefix);
+    struct dirent *entry;
+    while((entry = readdir(dir)) != NULL){
+        if(strncmp(entry->d_name, prefix, prefix_len) != 0) continue;
+        if(!wanted(entry->d_name + prefix_len, filter, filters)) continue;
+        char name[NAME_MAX + 2];
+        snprintf(name, sizeof(name), "/%s", entry->d_name);
+        watch(name);
+    }
+    closedir(dir);
+
+    for(int i = 0; i < watched_count; ){
+        if(watched[i].seen){
+            i++;
+            continue;
+        }
+        munmap((void *)watched[i].stats, sizeof(live_stats));
+        watched[i] = watched[--watched_count];
+    }
+}
+
+// Scratch for report(), reused for every row: the snapshot and the
+// interval's histogram never change size.
+static live_stats report_now;
+static latency_hist report_window;
+
+// One channel's last interval, printed as a table row or a CSV line.
+static void report(watched_channel *w, uint64_t now_ns, double elapsed, int batch){
+    live_stats *now = &report_now;
+    latency_hist *window = &report_window;
+    stats_snapshot(w->stats, now);
+
+    double seconds = (now_ns - w->last_ns) / 1e9;
+    const stats_side *p = &now->side[STATS_PRODUCER], *c = &now->side[STATS_CONSUMER];
+    const stats_side *lp = &w->last.side[STATS_PRODUCER], *lc = &w->last.side[STATS_CONSUMER];
+    // a side that re-attached started its counters over.
+    uint64_t received = c->messages >= lc->messages ? c->messages - lc->messages : c->messages;
+    uint64_t bytes = c->bytes >= lc->bytes ? c->bytes - lc->bytes : c->bytes;
+    uint64_t producer_blocks = p->blocks >= lp->blocks ? p->blocks - lp->blocks : p->blocks;
+    uint64_t consumer_blocks = c->blocks >= lc->blocks ? c->blocks - lc->blocks : c->blocks;
+    // the producer moves on between the two reads of a snapshot.
+    uint64_t occupancy = p->messages > c->messages ? p->messages - c->messages : 0;
+    if(occupancy > now->capacity) occupancy = now->capacity;
+
+    hist_reset(window);
+    int restarted = now->latency.count < w->last.latency.count;
+    for(int i = 0; i < HIST_BUCKETS; i++){
+        window->buckets[i] = now->latency.buckets[i] - (restarted ? 0 : w->last.latency.buckets[i]);
+        window->count += window->buckets[i];
+    }
+
+    if(batch){
+        printf("%.3f,%s,%.0f,%.3f,%.0f,%.0f,%llu,%u,%llu,%llu,%llu\n", elapsed, now->channel,
+               received / seconds, bytes / seconds / 1e6, producer_blocks / seconds, consumer_blocks / seconds,
+               (unsigned long long)occupancy, now->capacity,
+               (unsigned long long)hist_percentile(window, 50.0),
+               (unsigned long long)hist_percentile(window, 99.0),
+               (unsigned long long)hist_percentile(window, 99.9));
+    }else{
+        printf("%-16s %7d %7d %12.0f %9.2f %10.0f %10.0f %6llu/%-6u %10.1f %10.1f %10.1f\n",
+               now->channel, p->pid, c->pid, received / seconds, bytes / seconds / 1e6,
+               producer_blocks / seconds, consumer_blocks / seconds,
+               (unsigned long long)occupancy, now->capacity,
+               hist_percentile(window, 50.0) / 1e3,
+               hist_percentile(window, 99.0) / 1e3,
+               hist_percentile(window, 99.9) / 1e3);
+    }
+
+    w->last = *now;
+    w->last_ns = now_ns;
+}
+
+
+int main(int argc, char *argv[])
+{
+    long interval_ms = 1000;
+    long refreshes = 0;
+    int batch = 0;
+
+    int opt;
+    while((opt = getopt(argc, argv, "i:n:b")) != -1){
+        switch(opt){
+            case 'i': interval_ms = atol(optarg); break;
+            case 'n': refreshes = atol(optarg); break;
+            case 'b': batch = 1; break;
+            default:
+                fprintf(stderr, "usage: %s [-i interval_ms] [-n refreshes] [-b] [channel ...]\n", argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    if(interval_ms < 1){
+        fprintf(stderr, "interval must be at least 1 ms\n");
+        return EXIT_FAILURE;
+    }
+    char **filter = argv + optind;
+    int filters = argc - optind;
+
+    if(batch){
+        printf("elapsed_s,channel,msgs_per_s,mb_per_s,producer_blocks_per_s,consumer_blocks_per_s,"
+               "occupancy,capacity,latency_p50,latency_p99,latency_p99.9\n");
+    }
+    uint64_t start_ns = monotonic_ns();
+    rescan(filter, filters);
+    for(long n = 0; refreshes == 0 || n < refreshes; n++){
+        sleep_ms(interval_ms);
+        uint64_t now_ns = monotonic_ns();
+        double elapsed = (now_ns - start_ns) / 1e9;
+
+        if(!batch){
+            printf("\033[H\033[2J");
+            printf("channels: %d    interval: %ld ms    elapsed: %.1f s\n\n", watched_count, interval_ms, elapsed);
+            printf("%-16s %7s %7s %12s %9s %10s %10s %13s %10s %10s %10s\n", "CHANNEL", "PROD", "CONS",
+                   "MSGS/S", "MB/S", "P_BLK/S", "C_BLK/S", "OCCUPANCY", "P50_US", "P99_US", "P99.9_US");
+        }
+        for(int i = 0; i < watched_count; i++){
+            report(&watched[i], now_ns, elapsed, batch);
+        }
+        fflush(stdout);
+        rescan(filter, filters);
+    }
+
+    for(int i = 0; i < watched_count; i++){
+        munmap((void *)watched[i].stats, sizeof(live_stats));
+    }
+    return EXIT_SUCCESS;
+}
@@ -1,4 +1,5 @@
 #define _POSIX_C_SOURCE 200809L // CLOCK_MONOTONIC 
+#define _GNU_SOURCE // syscall() used by ../common/trace.h
 #include <sys/mman.h>
 #include <fcntl.h>     // O_* constants
 #include <sys/stat.h>  // mode_t and permission constants
@@ -11,64 +12,57 @@
 #include <time.h> // Measure time
 #include <string.h> // for memcpy
 
-static char template_message[MAX_MESSAGE_LEN];
+#include "producer.h"
 
-void producer(shared_data *data_ptr){
-
-    for(int i = 0;i<NUM_PRODUCTS;i++){
-        // look for a space.
-        if(sem_wait(&data_ptr->space) == -1){
-            perror("sem_wait(&data_ptr->space).");
-            break;
-        }
-        // protect read/write critical region
-        if(sem_wait(&data_ptr->semaphore) == -1){
-            perror("sem_wait(&data_ptr->semaphore).");
-            break;
-        }
-        
-        // write data into shared memory
-        #ifdef DEBUG
-            snprintf(data_ptr->message[data_ptr->curr_producer], sizeof(data_ptr->message[data_ptr->curr_producer]), "Product:%d", i);
-        #else
-            memcpy(data_ptr->message[data_ptr->curr_producer], template_message, MAX_MESSAGE_LEN);
-        #endif
-
-        data_ptr->curr_producer = (data_ptr->curr_producer + 1) % BUFFER_SIZE;
-
-        if(sem_post(&data_ptr->semaphore) == -1){
-            perror("sem_post(&data_ptr->semaphore)");
-            break;
-        }
-
-        if(sem_post(&data_ptr->product) == -1){
-            perror("sem_post(&data_ptr->product)");
-            break;
-        }
-    
-    }    
 
 
+#ifdef MEMFD_RENDEZVOUS
+// Wait for the consumer on our channel and hand it the segment.
+static int offer_segment(int file_descriptor){
+    int sock = rendezvous_connect(channel_name());
+    if(sock == -1){
+        return -1;
+    }
+    channel_hello hello = { .sent_ns = monotonic_ns(), .segment_size = SHM_SIZE };
+    int r = send_fds(sock, &file_descriptor, 1, &hello, sizeof(hello));
+    close(sock);
+    return r;
 }
-
-
-double get_elapsed_seconds(struct timespec start, struct timespec end) {
-    return (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
-}
+#endif
 
 
 int main()
 {
-    // create the template message for each product
-    memset(template_message, 'A', MAX_MESSAGE_LEN);
-    template_message[MAX_MESSAGE_LEN - 1] = '\0';
+    if(producer_prepare() == -1){
+        return EXIT_FAILURE;
+    }
+
+    // exec'd by launcher.c: the segment is already set up.
+    shared_data *launched;
+    int runs;
+    int launched_mode = launched_segment(&launched, &runs);
+    if(launched_mode != 0){
+        if(launched_mode == -1 || launched_producer(launched, runs) == -1){
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
 
+    #ifndef MEMFD_RENDEZVOUS
     // named semaphore for initialization check.
     sem_t* ready = sem_open(READY_SEMAPHORE, O_CREAT, 0600, 0);
     if(ready == SEM_FAILED){
         perror("sem_open() failed.");
         return EXIT_FAILURE;
     }
+    #endif
+
+    // the trace ring and the stats segment are mapped (and the ring
+    // pre-faulted) before the clock starts, so they stay out of
+    // initialize_time.
+    if(TRACE_OPEN("producer") == -1 || CHANNEL_STATS_OPEN(STATS_PRODUCER) == -1){
+        return EXIT_FAILURE;
+    }
 
     struct timespec start_time, communication_start_time, communication_end_time;
 
@@ -76,7 +70,11 @@ int main()
     clock_gettime(CLOCK_MONOTONIC, &start_time);
 
 
+    #ifdef MEMFD_RENDEZVOUS
+    int file_descriptor = memfd_create("ipc_segment", MFD_CLOEXEC);
+    #else
     int file_descriptor = shm_open(SHARE_MEMORY_NAME, O_RDWR|O_CREAT, 0600);
+    #endif
 
     if(file_descriptor == -1)
     {
@@ -100,35 +98,47 @@ int main()
         return EXIT_FAILURE;
     }
     LOG("mmap() success.\n");
+    #ifndef MEMFD_RENDEZVOUS
     close(file_descriptor);
+    #endif
 
 
 
     shared_data *data_ptr = (shared_data*)buffer;
 
-    // --- Initialize circular buffer index ---
-    data_ptr->curr_producer = 0;
-    data_ptr->curr_consumer = 0;
-
-    // --- Initialize semaphore ---
-    if(sem_init(&data_ptr->semaphore, 1, 1) == -1 ||
-       sem_init(&data_ptr->space, 1, BUFFER_SIZE) == -1 ||
-       sem_init(&data_ptr->product, 1, 0) == -1||
-       sem_init(&data_ptr->complete, 1, 0)== -1){
-        perror("sem_init failed.");
+    #ifdef ADAPTIVE_BUFFER
+    if(tuner_init() == -1){
         return EXIT_FAILURE;
     }
+    #endif
 
-    // --- For time measurement ---
-    sem_init(&data_ptr->consumer_ready, 1, 0); 
-    sem_init(&data_ptr->start_gun_sem, 1, 0); 
+    // --- Initialize buffer index and semaphores ---
+    if(init_shared_data(data_ptr) == -1){
+        return EXIT_FAILURE;
+    }
 
     LOG("sem_init() success.\n");
+    #ifdef MEMFD_RENDEZVOUS
+    int offered = offer_segment(file_descriptor);
+    close(file_descriptor);
+    if(offered == -1){
+        return EXIT_FAILURE;
+    }
+    #else
     sem_post(ready);
     sem_close(ready);
+    #endif
     
     // Wait for consumer (to handle possible OS scheduling delays).
     sem_wait(&data_ptr->consumer_ready);
+    if(data_ptr->failed){
+        fprintf(stderr, "producer: consumer failed to start.\n");
+        #ifndef MEMFD_RENDEZVOUS
+        sem_unlink(READY_SEMAPHORE);
+        shm_unlink(SHARE_MEMORY_NAME);
+        #endif
+        return EXIT_FAILURE;
+    }
 
     // start communication time measurement.
     clock_gettime(CLOCK_MONOTONIC, &communication_start_time);
@@ -136,6 +146,12 @@ int main()
 
     // --- Read from/write to the shared memory buffer ---
     producer(data_ptr);
+    #ifdef ADAPTIVE_BUFFER
+    fclose(tuner.log);
+    #endif
+    if(producer_finish() == -1){
+        return EXIT_FAILURE;
+    }
 
     if(sem_wait(&data_ptr->complete) == -1){
         perror("sem_wait(complete) fail.");
@@ -143,21 +159,23 @@ int main()
     }
     // end conmunication time measurement.
     clock_gettime(CLOCK_MONOTONIC, &communication_end_time);
+    TRACE_CLOSE();
+    STATS_CLOSE();
 
+    #ifdef OPEN_LOOP
+    // the consumer is done with the histogram once it posted `complete`.
+    latency_hist latency = data_ptr->latency;
+    #endif
+    int failed = data_ptr->failed;
 
+
+    #ifndef MEMFD_RENDEZVOUS
     sem_unlink(READY_SEMAPHORE);
+    #endif
     
-    if(sem_destroy(&data_ptr->semaphore) == -1||
-    sem_destroy(&data_ptr->space) == -1 ||
-    sem_destroy(&data_ptr->product) == -1 ||
-    sem_destroy(&data_ptr->complete) == -1){
-        perror("sem_destroy failed.");
+    if(destroy_shared_data(data_ptr) == -1){
         return EXIT_FAILURE;
     }
-    
-    // --- Destroy sem use for time measurement ---
-    sem_destroy(&data_ptr->consumer_ready); 
-    sem_destroy(&data_ptr->start_gun_sem); 
 
 
     // unmap shared memory object from virtual memory.
@@ -169,6 +187,7 @@ int main()
 
 
     
+    #ifndef MEMFD_RENDEZVOUS
     int r = shm_unlink(SHARE_MEMORY_NAME);
 
     if(r == -1)
@@ -177,14 +196,23 @@ int main()
         return EXIT_FAILURE;
     } 
     LOG("shm_unlink() success.\n");
+    #endif
 
+    // the consumer gave up mid-run: no result line.
+    if(failed){
+        return EXIT_FAILURE;
+    }
 
     // --- Show measurement result ---
     double initialize_time = get_elapsed_seconds(start_time, communication_start_time);
     double communication_time = get_elapsed_seconds(communication_start_time, communication_end_time);
     LOG("Total run time: %.9f seconds\n", initialize_time);
     LOG("Total communication time: %.9f seconds\n", communication_time);
-    printf("%.9f,%.9f\n",initialize_time,communication_time);
+    #ifdef OPEN_LOOP
+    print_result(initialize_time, communication_time, &latency);
+    #else
+    print_result(initialize_time, communication_time, NULL);
+    #endif
 
     return EXIT_SUCCESS;
 
@@ -0,0 +1,328 @@
+#ifndef PRODUCER_H
+#define PRODUCER_H
+
+// --- Producer side ---
+// The producer loop and its per-process state. Included by producer.c and
+// by launcher.c, which runs the same loop in a forked child.
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include "common.h"
+
+static char template_message[MAX_MESSAGE_LEN];
+static workload producer_work;
+static volatile uint64_t producer_result;
+#ifdef JOURNAL
+static journal_writer journal;
+#endif
+
+
+static double get_elapsed_seconds(struct timespec start, struct timespec end) {
+    return (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+}
+
+
+#ifdef ADAPTIVE_BUFFER
+// --- Buffer autotuner ---
+// Every TUNE_INTERVAL messages the producer looks at the interval's
+// throughput, how often each side blocked and the average occupancy, then
+//   1. halves the capacity if the Little's-law queueing delay is above
+//      TUNE_TARGET_DELAY_US (when set),
+//   2. reverts the last grow if it did not buy TUNE_TOLERANCE throughput,
+//   3. doubles the capacity if the producer found the ring full too often,
+//   4. trims headroom the interval left unused,
+// and appends the decision to TUNE_LOG_FILE.
+typedef struct{
+    FILE *log;
+    struct timespec start, interval_start;
+    unsigned long producer_blocks;          // times the ring was full
+    unsigned long last_producer_blocks, last_consumer_blocks;
+    long occupancy_sum;
+    int max_occupancy;
+    int ceiling;                            // largest capacity worth trying
+    int previous_capacity;                  // capacity before the last grow
+    int last_grew;
+    int capped_intervals;
+    int shrink_debt;                        // space tokens still to withdraw
+    double last_rate;
+} tuner_state;
+
+static tuner_state tuner;
+#define PRODUCER_BLOCKS (&tuner.producer_blocks)
+
+// Withdraw free space tokens owed by an earlier shrink. Tokens held by
+// in-flight messages are collected later, as the consumer returns them.
+static void absorb_shrink_debt(shared_data *data_ptr){
+    while(tuner.shrink_debt > 0 && sem_trywait(&data_ptr->space) == 0){
+        tuner.shrink_debt--;
+    }
+}
+
+static void set_capacity(shared_data *data_ptr, int capacity){
+    int delta = capacity - data_ptr->capacity;
+    data_ptr->capacity = capacity;
+    for(; delta > 0 && tuner.shrink_debt > 0; delta--) tuner.shrink_debt--;
+    for(; delta > 0; delta--) sem_post(&data_ptr->space);
+    if(delta < 0) tuner.shrink_debt -= delta;
+    absorb_shrink_debt(data_ptr);
+}
+
+// Open the trajectory log. The shared capacity state is set up by
+// init_shared_data(); the rest of the tuner is reset by producer().
+static int tuner_init(void){
+    tuner.log = fopen(TUNE_LOG_FILE, "w");
+    if(tuner.log == NULL){
+        perror("fopen(TUNE_LOG_FILE) failed.");
+        return -1;
+    }
+    fprintf(tuner.log, "Message,Elapsed_s,Capacity,NextCapacity,Rate_msgs_s,FullRatio,EmptyRatio,AvgOccupancy,EstDelay_us,Action\n");
+    return 0;
+}
+
+static void tune(shared_data *data_ptr, int produced){
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    unsigned long consumer_blocks = __atomic_load_n(&data_ptr->consumer_blocks, __ATOMIC_RELAXED);
+    double rate = TUNE_INTERVAL / get_elapsed_seconds(tuner.interval_start, now);
+    double full_ratio = (double)(tuner.producer_blocks - tuner.last_producer_blocks) / TUNE_INTERVAL;
+    double empty_ratio = (double)(consumer_blocks - tuner.last_consumer_blocks) / TUNE_INTERVAL;
+    double avg_occupancy = (double)tuner.occupancy_sum / TUNE_INTERVAL;
+    double delay_us = avg_occupancy / rate * 1e6;
+
+    int cap = data_ptr->capacity;
+    int next = cap;
+    const char *action = "hold";
+    int grew = 0;
+
+    if(TUNE_TARGET_DELAY_US > 0 && delay_us > TUNE_TARGET_DELAY_US && cap > 1){
+        next = cap / 2;
+        tuner.ceiling = next;
+        action = "shrink-delay";
+    }else if(tuner.last_grew && rate < tuner.last_rate * (1.0 + TUNE_TOLERANCE)){
+        next = tuner.previous_capacity;
+        tuner.ceiling = next;
+        action = "revert";
+    }else if(full_ratio > TUNE_FULL_THRESHOLD && cap < tuner.ceiling){
+        next = cap * 2 < tuner.ceiling ? cap * 2 : tuner.ceiling;
+        tuner.previous_capacity = cap;
+        action = "grow";
+        grew = 1;
+    }else if(2 * (tuner.max_occupancy + 1) <= cap){
+        next = tuner.max_occupancy + 1;
+        action = "trim";
+    }
+
+    // re-open a capped search after a while in case the workload changed.
+    if(tuner.ceiling < BUFFER_SIZE && ++tuner.capped_intervals >= TUNE_REPROBE_INTERVALS){
+        tuner.ceiling = BUFFER_SIZE;
+        tuner.capped_intervals = 0;
+    }
+
+    fprintf(tuner.log, "%d,%.9f,%d,%d,%.0f,%.4f,%.4f,%.2f,%.2f,%s\n",
+            produced, get_elapsed_seconds(tuner.start, now), cap, next,
+            rate, full_ratio, empty_ratio, avg_occupancy, delay_us, action);
+    if(next != cap) set_capacity(data_ptr, next);
+
+    tuner.last_grew = grew;
+    tuner.last_rate = rate;
+    tuner.last_producer_blocks = tuner.producer_blocks;
+    tuner.last_consumer_blocks = consumer_blocks;
+    tuner.occupancy_sum = 0;
+    tuner.max_occupancy = 0;
+    tuner.interval_start = now;
+}
+#else
+#define PRODUCER_BLOCKS NULL
+#endif
+
+
+// Write message i into `payload` (a ring slot, or an arena block).
+static inline void fill_message(char *payload, int i, uint64_t intended_ns){
+    #ifdef DEBUG
+        snprintf(payload, MAX_MESSAGE_LEN, "Product:%d", i);
+    #else
+        (void)i;
+        write_message(payload, template_message, MAX_MESSAGE_LEN);
+    #endif
+    #ifdef OPEN_LOOP
+        write_send_stamp(payload, MAX_MESSAGE_LEN, intended_ns);
+    #elif defined(LIVE_STATS)
+        (void)intended_ns;
+        write_send_stamp(payload, MAX_MESSAGE_LEN, monotonic_ns());
+    #else
+        (void)intended_ns;
+    #endif
+}
+
+static void producer(shared_data *data_ptr){
+
+    #ifdef ADAPTIVE_BUFFER
+    FILE *log = tuner.log;
+    memset(&tuner, 0, sizeof(tuner));
+    tuner.log = log;
+    tuner.ceiling = BUFFER_SIZE;
+    clock_gettime(CLOCK_MONOTONIC, &tuner.start);
+    tuner.interval_start = tuner.start;
+    #endif
+
+    #ifdef OPEN_LOOP
+    open_loop_pacer pacer;
+    pacer_start(&pacer, monotonic_ns());
+    #endif
+
+    for(int i = 0;i<NUM_PRODUCTS;i++){
+        uint64_t intended_ns = 0;
+        #ifdef OPEN_LOOP
+        // the clock starts before we look for space, so a full ring shows
+        // up as latency instead of as a slower schedule.
+        intended_ns = pacer_wait(&pacer);
+        #endif
+
+        // build the message outside the critical region.
+        if(producer_work.run != workload_none){
+            producer_result = producer_work.run(&producer_work, template_message, MAX_MESSAGE_LEN);
+        }
+
+        #ifdef SLAB_ARENA
+        // fill an arena block up front; only its descriptor goes in the ring.
+        uint64_t handle = arena_alloc(ARENA(data_ptr), MAX_MESSAGE_LEN);
+        if(handle == ARENA_NULL){
+            fprintf(stderr, "arena_alloc() failed: arena exhausted.\n");
+            break;
+        }
+        fill_message(arena_ptr(ARENA(data_ptr), handle), i, intended_ns);
+        #elif defined(JOURNAL)
+        // append the record first; only its journal_ref goes in the ring.
+        journal_ref ref;
+        char *record = journal_reserve(&journal, MAX_MESSAGE_LEN, &ref);
+        if(record == NULL){
+            break;
+        }
+        fill_message(record, i, intended_ns);
+        if(journal_commit(&journal) == -1){
+            break;
+        }
+        #endif
+
+        // look for a space.
+        #ifdef ADAPTIVE_BUFFER
+        if(tuner.shrink_debt > 0) absorb_shrink_debt(data_ptr);
+        #endif
+        if(ring_sem_wait(&data_ptr->space, PRODUCER_BLOCKS, TRACE_RES_SPACE, i) == -1){
+            perror("sem_wait(&data_ptr->space).");
+            break;
+        }
+        if(__atomic_load_n(&data_ptr->failed, __ATOMIC_ACQUIRE)){
+            fprintf(stderr, "producer: consumer failed, stopping at message %d.\n", i);
+            break;
+        }
+        // protect read/write critical region
+        if(ring_sem_wait(&data_ptr->semaphore, NULL, TRACE_RES_LOCK, i) == -1){
+            perror("sem_wait(&data_ptr->semaphore).");
+            break;
+        }
+
+        #ifdef ADAPTIVE_BUFFER
+        int occupancy = 0;
+        sem_getvalue(&data_ptr->product, &occupancy);
+        tuner.occupancy_sum += occupancy;
+        if(occupancy > tuner.max_occupancy) tuner.max_occupancy = occupancy;
+        #endif
+
+        int slot = producer_claim_slot(data_ptr);
+        
+        // write data into shared memory
+        #ifdef SLAB_ARENA
+            payload_desc desc = { .handle = handle, .length = MAX_MESSAGE_LEN };
+            memcpy(data_ptr->message[slot], &desc, sizeof(desc));
+        #elif defined(JOURNAL)
+            memcpy(data_ptr->message[slot], &ref, sizeof(ref));
+        #else
+            fill_message(data_ptr->message[slot], i, intended_ns);
+        #endif
+
+        data_ptr->curr_producer = (data_ptr->curr_producer + 1) % BUFFER_SIZE;
+
+        if(sem_post(&data_ptr->semaphore) == -1){
+            perror("sem_post(&data_ptr->semaphore)");
+            break;
+        }
+
+        if(sem_post(&data_ptr->product) == -1){
+            perror("sem_post(&data_ptr->product)");
+            break;
+        }
+        TRACE_EVENT(TRACE_ENQUEUE, TRACE_RES_NONE, i);
+        STATS_MESSAGE(MAX_MESSAGE_LEN);
+
+        #ifdef ADAPTIVE_BUFFER
+        if((i + 1) % TUNE_INTERVAL == 0) tune(data_ptr, i + 1);
+        #endif
+    
+    }    
+
+}
+
+
+// Per-process setup, before the segment is touched: the message template,
+// the PRODUCER_WORKLOAD selection and, under JOURNAL, a fresh journal.
+static int producer_prepare(void){
+    // create the template message for each product
+    memset(template_message, 'A', MAX_MESSAGE_LEN);
+    template_message[MAX_MESSAGE_LEN - 1] = '\0';
+
+    #ifdef JOURNAL
+    if(journal_create(&journal, journal_name()) == -1){
+        return -1;
+    }
+    #endif
+    return workload_from_env(&producer_work, "PRODUCER_WORKLOAD", "none");
+}
+
+// Final sync and end-of-log mark; the journal files stay behind.
+static int producer_finish(void){
+    #ifdef JOURNAL
+    return journal_close(&journal);
+    #else
+    return 0;
+    #endif
+}
+
+// Producer body under launcher.c: `runs` rounds of
+// barrier (segment reset, go) -> producer() -> barrier (done),
+// with the start/end of every round recorded in producer_stats.
+static int launched_producer(shared_data *data_ptr, int runs){
+    #ifdef ADAPTIVE_BUFFER
+    if(tuner_init() == -1){
+        return -1;
+    }
+    #endif
+    if(TRACE_OPEN("producer") == -1 || CHANNEL_STATS_OPEN(STATS_PRODUCER) == -1){
+        return -1;
+    }
+    sem_post(&data_ptr->launch_ready);
+
+    for(int run = 0; run < runs; run++){
+        pthread_barrier_wait(&data_ptr->launch_barrier);
+        data_ptr->producer_stats.start_ns = monotonic_ns();
+        producer(data_ptr);
+        data_ptr->producer_stats.end_ns = monotonic_ns();
+        pthread_barrier_wait(&data_ptr->launch_barrier);
+        if(data_ptr->failed) break;
+    }
+
+    TRACE_CLOSE();
+    STATS_CLOSE();
+    #ifdef ADAPTIVE_BUFFER
+    fclose(tuner.log);
+    #endif
+    if(producer_finish() == -1){
+        return -1;
+    }
+    return data_ptr->failed ? -1 : 0;
+}
+
+#endif
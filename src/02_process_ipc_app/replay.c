@@ -0,0 +1,94 @@
+#define _POSIX_C_SOURCE 200809L // CLOCK_MONOTONIC
+#define _GNU_SOURCE
+#include <stdio.h>     // printf
+#include <stdlib.h>    // macros
+#include <unistd.h>    // getopt
+#include <sched.h>
+#include <time.h>
+#include "common.h"
+
+// --- Journal replay ---
+// Reads the journal a -DJOURNAL producer leaves behind (or is still
+// writing), starting at any record:
+//
+//   ./replay [-s first_seq] [-f]
+//
+//   -s  start at this sequence number (default 0, the first record)
+//   -f  follow: wait for the journal to appear and for new records until
+//       the producer closes it, instead of stopping at the current end
+//
+// Every payload is checksummed like the consumer does, and the records'
+// sequence numbers are checked for gaps. Output:
+//   records,seconds,msgs_per_s,MB_per_s,first_seq,gaps
+
+#ifndef JOURNAL
+    #include "../common/journal.h"
+#endif
+
+static volatile uint64_t final_checksum;
+
+int main(int argc, char *argv[])
+{
+    uint64_t first_seq = 0;
+    int follow = 0;
+
+    int opt;
+    while((opt = getopt(argc, argv, "s:f")) != -1){
+        switch(opt){
+            case 's': first_seq = strtoull(optarg, NULL, 10); break;
+            case 'f': follow = 1; break;
+            default:
+                fprintf(stderr, "usage: %s [-s first_seq] [-f]\n", argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+
+    journal_reader reader;
+    journal_cursor cursor;
+    if(journal_reader_init(&reader, journal_name()) == -1){
+        return EXIT_FAILURE;
+    }
+    while(journal_seek(&cursor, &reader, first_seq) == -1){
+        if(!follow){
+            fprintf(stderr, "no journal at %s.0\n", journal_name());
+            return EXIT_FAILURE;
+        }
+        sched_yield();
+    }
+
+    uint64_t records = 0, bytes = 0, gaps = 0;
+    uint64_t expected = first_seq, start_seq = 0;
+    const journal_record_header *rec;
+    uint64_t start_ns = monotonic_ns();
+
+    for(;;){
+        int r = journal_next(&cursor, &rec);
+        if(r == JOURNAL_END) break;
+        if(r == JOURNAL_CAUGHT_UP){
+            if(!follow) break;
+            sched_yield();
+            continue;
+        }
+        if(records == 0) start_seq = expected = rec->seq;
+        if(rec->seq != expected) gaps++;
+        expected = rec->seq + 1;
+
+        const char *payload = (const char *)(rec + 1);
+        uint64_t total_checksum = 0;
+        for(uint32_t j = 0; j < rec->length; j++){
+            total_checksum += payload[j];
+        }
+        final_checksum = total_checksum;
+        LOG("Replay %llu:%s\n", (unsigned long long)rec->seq, payload);
+        records++;
+        bytes += rec->length;
+    }
+
+    double seconds = (monotonic_ns() - start_ns) / 1e9;
+    printf("%llu,%.9f,%.0f,%.1f,%llu,%llu\n", (unsigned long long)records, seconds,
+           seconds > 0 ? records / seconds : 0.0, seconds > 0 ? bytes / seconds / 1e6 : 0.0,
+           (unsigned long long)start_seq, (unsigned long long)gaps);
+
+    journal_reader_close(&reader);
+    return gaps == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
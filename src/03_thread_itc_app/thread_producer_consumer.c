@@ -1,4 +1,5 @@
 #define _POSIX_C_SOURCE 200809L // CLOCK_MONOTONIC 
+#define _GNU_SOURCE // syscall() used by ../common/trace.h
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>     // macros
@@ -7,6 +8,11 @@
 #include <semaphore.h> // for time measurement (wait until threads are ready).
 #include <time.h> 
 #include <stdint.h>
+#include "../common/layout.h"
+#include "../common/trace.h"
+#include "../common/latency_hist.h"
+#include "../common/open_loop.h"
+#include "../common/workload.h"
 
 
 #ifdef DEBUG
@@ -29,25 +35,51 @@
 #ifndef MAX_MESSAGE_LEN
     #define MAX_MESSAGE_LEN 1024
 #endif
+
+// slots padded to whole cache lines under -DPADDED_LAYOUT (../common/layout.h).
+#define SLOT_LEN LAYOUT_SLOT_LEN(MAX_MESSAGE_LEN)
+
+// non-temporal copy and prefetch for large messages (needs MAX_MESSAGE_LEN).
+#include "../common/stream_copy.h"
+
+// --- Open loop ---
+// -DOPEN_LOOP paces the producer at TARGET_RATE (see ../common/open_loop.h)
+// and the consumer records per-message latency into data_ptr->latency.
+#ifdef OPEN_LOOP
+_Static_assert(MAX_MESSAGE_LEN >= SEND_STAMP_LEN, "OPEN_LOOP needs room for the send stamp");
+#endif
+
 static volatile uint64_t final_checksum;
 static char template_message[MAX_MESSAGE_LEN];
+static workload producer_work, consumer_work;
+static volatile uint64_t producer_result;
 
 typedef struct {
-    pthread_mutex_t mutex;
-    pthread_cond_t  product_cond;
-    pthread_cond_t  space_cond;
+    pthread_mutex_t mutex CACHE_ALIGNED;
+    pthread_cond_t  product_cond CACHE_ALIGNED;  // consumer sleeps here
+    pthread_cond_t  space_cond CACHE_ALIGNED;    // producer sleeps here
     
     // --- Circular buffer ---
-    int message_ready;
-    char message[BUFFER_SIZE][MAX_MESSAGE_LEN];
-    int curr_producer, curr_consumer;
+    int message_ready CACHE_ALIGNED;
+    char message[BUFFER_SIZE][SLOT_LEN] CACHE_ALIGNED;
+    int curr_producer CACHE_ALIGNED;    // producer-side hot state
+    int curr_consumer CACHE_ALIGNED;    // consumer-side hot state
+
+#ifdef OPEN_LOOP
+    latency_hist latency CACHE_ALIGNED; // written by the consumer only
+#endif
 
     /* --- For time measurement --- */
-    sem_t ready_sem; 
+    sem_t ready_sem CACHE_ALIGNED; 
     sem_t start_gun_sem; 
 
+    // trace rings opened by main, attached by each thread.
+    trace_handle producer_trace;
+    trace_handle consumer_trace;
+
 } shared_data;
 
+
 double get_elapsed_seconds(struct timespec start, struct timespec end) {
     return (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
 }
@@ -57,12 +89,29 @@ double get_elapsed_seconds(struct timespec start, struct timespec end) {
 void* producer(void* arg) {
     shared_data *data_ptr = (shared_data*)arg;
 
+    TRACE_ATTACH(data_ptr->producer_trace);
+
     // --- For time measurement ---
     sem_post(&data_ptr->ready_sem);
     sem_wait(&data_ptr->start_gun_sem);
 
+    #ifdef OPEN_LOOP
+    open_loop_pacer pacer;
+    pacer_start(&pacer, monotonic_ns());
+    #endif
 
     for (int i = 0; i < NUM_PRODUCTS; i++) {
+        #ifdef OPEN_LOOP
+        // the clock starts before we look for space, so a full buffer shows
+        // up as latency instead of as a slower schedule.
+        uint64_t intended_ns = pacer_wait(&pacer);
+        #endif
+
+        // build the message outside the critical region.
+        if (producer_work.run != workload_none) {
+            producer_result = producer_work.run(&producer_work, template_message, MAX_MESSAGE_LEN);
+        }
+
         // lock the mutex before write
         if (pthread_mutex_lock(&data_ptr->mutex) != 0) {
             perror("pthread_mutex_lock in producer");
@@ -71,16 +120,21 @@ void* producer(void* arg) {
 
         // wait for a space.
         while (data_ptr->message_ready >= BUFFER_SIZE) {
+            TRACE_EVENT(TRACE_BLOCK, TRACE_RES_SPACE, i);
             if (pthread_cond_wait(&data_ptr->space_cond, &data_ptr->mutex) != 0) {
                 perror("producer cond_wait space fail.");
             }
+            TRACE_EVENT(TRACE_WAKE, TRACE_RES_SPACE, i);
         }
         
         // write data into shared memory
         #ifdef DEBUG
             sprintf(data_ptr->message[data_ptr->curr_producer], "Product:%d", i);
         #else
-            memcpy(data_ptr->message[data_ptr->curr_producer],template_message, MAX_MESSAGE_LEN);
+            write_message(data_ptr->message[data_ptr->curr_producer], template_message, MAX_MESSAGE_LEN);
+        #endif
+        #ifdef OPEN_LOOP
+            write_send_stamp(data_ptr->message[data_ptr->curr_producer], MAX_MESSAGE_LEN, intended_ns);
         #endif
         LOG("Producer created: %s\n", data_ptr->message[data_ptr->curr_producer]);
         data_ptr->curr_producer = (data_ptr->curr_producer + 1) % BUFFER_SIZE;
@@ -97,7 +151,9 @@ void* producer(void* arg) {
             perror("pthread_mutex_unlock");
             break;
         }
+        TRACE_EVENT(TRACE_ENQUEUE, TRACE_RES_NONE, i);
     }
+    TRACE_CLOSE();
     return NULL;
 }
 
@@ -105,6 +161,8 @@ void* producer(void* arg) {
 void* consumer(void* arg) {
     shared_data *data_ptr = (shared_data*)arg;
 
+    TRACE_ATTACH(data_ptr->consumer_trace);
+
     // --- For time measurement ---
     sem_post(&data_ptr->ready_sem);
     sem_wait(&data_ptr->start_gun_sem);
@@ -117,18 +175,29 @@ void* consumer(void* arg) {
         
         // wait for a product 
         while (data_ptr->message_ready < 1) {
+            TRACE_EVENT(TRACE_BLOCK, TRACE_RES_PRODUCT, i);
             if (pthread_cond_wait(&data_ptr->product_cond, &data_ptr->mutex) != 0) {
                 perror("pthread_cond_wait(product_cond)");
             }
+            TRACE_EVENT(TRACE_WAKE, TRACE_RES_PRODUCT, i);
         }
 
+        #ifdef OPEN_LOOP
+        hist_record(&data_ptr->latency, monotonic_ns() - read_send_stamp(data_ptr->message[data_ptr->curr_consumer], MAX_MESSAGE_LEN));
+        #endif
+
         // read data from shared memory
         LOG("Consumer got:   %s\n", data_ptr->message[data_ptr->curr_consumer]);
-        uint64_t total_checksum = 0;
-        for (int j = 0; j < MAX_MESSAGE_LEN; j++) {
-            total_checksum += data_ptr->message[data_ptr->curr_consumer][j];
+        // prefetch the next slot only if the producer has already filled it.
+        const char *next = NULL;
+        if (USE_STREAM_COPY && data_ptr->message_ready > 1) {
+            next = data_ptr->message[(data_ptr->curr_consumer + 1) % BUFFER_SIZE];
+        }
+        if (consumer_work.run == workload_checksum) {
+            final_checksum = checksum_message(data_ptr->message[data_ptr->curr_consumer], next, MAX_MESSAGE_LEN);
+        } else {
+            final_checksum = consumer_work.run(&consumer_work, data_ptr->message[data_ptr->curr_consumer], MAX_MESSAGE_LEN);
         }
-        final_checksum = total_checksum;
 
 
         data_ptr->curr_consumer = (data_ptr->curr_consumer + 1) % BUFFER_SIZE;
@@ -144,8 +213,10 @@ void* consumer(void* arg) {
             perror("pthread_mutex_unlock");
             break;
         }
+        TRACE_EVENT(TRACE_DEQUEUE, TRACE_RES_NONE, i);
         
     }
+    TRACE_CLOSE();
     return NULL;
 }
 
@@ -160,10 +231,30 @@ int main() {
     sem_init(&data.ready_sem, 0, 0); // pshared mode 0:shared between threads, initial value 0.
     sem_init(&data.start_gun_sem, 0, 0); 
 
+    #ifdef OPEN_LOOP
+    hist_reset(&data.latency);
+    #endif
+
     // create the template message for each product
     memset(template_message, 'A', MAX_MESSAGE_LEN);
     template_message[MAX_MESSAGE_LEN - 1] = '\0';
 
+    // per-message work, picked at run time (see ../common/workload.h).
+    if (workload_from_env(&producer_work, "PRODUCER_WORKLOAD", "none") == -1 ||
+        workload_from_env(&consumer_work, "WORKLOAD", "checksum") == -1) {
+        return EXIT_FAILURE;
+    }
+
+    // both trace rings are mapped (and pre-faulted) here, before the clock
+    // starts, then handed to their threads.
+    if (TRACE_OPEN("producer") == -1) {
+        return EXIT_FAILURE;
+    }
+    data.producer_trace = TRACE_DETACH();
+    if (TRACE_OPEN("consumer") == -1) {
+        return EXIT_FAILURE;
+    }
+    data.consumer_trace = TRACE_DETACH();
 
 
     // timespec for time measurement.
@@ -237,7 +328,15 @@ int main() {
     double communication_time = get_elapsed_seconds(communication_start_time, communication_end_time);
     LOG("Total run time: %.9f seconds\n", initialize_time);
     LOG("Total communication time: %.9f seconds\n", communication_time);
+    #ifdef OPEN_LOOP
+    // init,comm,offered_rate,achieved_rate,mean,p50,p90,p99,p99.9,max (ns)
+    printf("%.9f,%.9f,%d,%.0f",initialize_time,communication_time,
+           TARGET_RATE, NUM_PRODUCTS / communication_time);
+    hist_print_csv(&data.latency);
+    printf("\n");
+    #else
     printf("%.9f,%.9f\n",initialize_time,communication_time);
+    #endif
 
 
     // --- Destroy sem use for time measurement ---
@@ -7,6 +7,7 @@
 #include <semaphore.h>
 #include <time.h>       // For time measurement
 #include <sys/mman.h>   // For mmap and munmap
+#include "../common/layout.h"
 
 
 #ifdef DEBUG
@@ -26,18 +27,22 @@
 #endif
 #define MAX_MESSAGE_LEN 1024
 
+// slots padded to whole cache lines under -DPADDED_LAYOUT (../common/layout.h).
+#define SLOT_LEN LAYOUT_SLOT_LEN(MAX_MESSAGE_LEN)
+
 
 typedef struct{
-    sem_t semaphore;
-    sem_t product;
-    sem_t space;
+    sem_t semaphore CACHE_ALIGNED;
+    sem_t product CACHE_ALIGNED;    // posted by producer, waited by consumer
+    sem_t space CACHE_ALIGNED;      // posted by consumer, waited by producer
 
 
-    char message[BUFFER_SIZE][MAX_MESSAGE_LEN];
-    int curr_producer, curr_consumer;
+    char message[BUFFER_SIZE][SLOT_LEN] CACHE_ALIGNED;
+    int curr_producer CACHE_ALIGNED;    // producer-side hot state
+    int curr_consumer CACHE_ALIGNED;    // consumer-side hot state
 
     /* --- For time measurement --- */
-    sem_t complete;
+    sem_t complete CACHE_ALIGNED;
     sem_t producer_ready;
     sem_t consumer_ready;
     sem_t start_gun_sem;
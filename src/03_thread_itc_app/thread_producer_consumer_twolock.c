@@ -0,0 +1,295 @@
+#define _POSIX_C_SOURCE 200809L // CLOCK_MONOTONIC
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>     // macros
+#include <unistd.h>
+#include <pthread.h>
+#include <semaphore.h> // for time measurement (wait until threads are ready).
+#include <time.h>
+#include <stdint.h>
+#include "../common/layout.h"
+
+
+#ifdef DEBUG
+    #define LOG(msg, ...) printf(msg, ##__VA_ARGS__);
+#else
+    #define LOG(msg, ...)
+#endif
+
+
+// --- Workload setting ---
+#ifndef NUM_PRODUCTS
+    #define NUM_PRODUCTS 100000
+#endif
+
+// --- Buffer setting ---
+#ifndef BUFFER_SIZE
+    #define BUFFER_SIZE 1
+#endif
+
+#ifndef MAX_MESSAGE_LEN
+    #define MAX_MESSAGE_LEN 1024
+#endif
+
+// slots padded to whole cache lines under -DPADDED_LAYOUT (../common/layout.h).
+#define SLOT_LEN LAYOUT_SLOT_LEN(MAX_MESSAGE_LEN)
+
+// --- Two-lock queue ---
+// Michael-Scott style: the producer only takes head_lock and the consumer
+// only takes tail_lock, so a write and a read of different slots never
+// wait for each other. The sides share nothing but the atomic
+// message_ready count.
+//
+// Waiter-aware signaling: a side that has to sleep first registers in its
+// waiter count, then rechecks message_ready and sleeps. The other side
+// updates message_ready first, then reads the waiter count, and only if
+// someone is registered takes the sleeper's lock and signals. Both orders
+// are sequentially consistent, so either the sleeper sees the new count or
+// the signaller sees the waiter, and a signal is never lost. Taking the
+// sleeper's lock before signalling makes sure it is already inside
+// pthread_cond_wait().
+
+static volatile uint64_t final_checksum;
+static char template_message[MAX_MESSAGE_LEN];
+
+typedef struct {
+    // --- producer side ---
+    pthread_mutex_t head_lock CACHE_ALIGNED;
+    pthread_cond_t  space_cond;         // producer sleeps here
+    int space_waiters;
+    int curr_producer;
+    uint64_t signals_sent;              // product_cond signals issued
+
+    // --- consumer side ---
+    pthread_mutex_t tail_lock CACHE_ALIGNED;
+    pthread_cond_t  product_cond;       // consumer sleeps here
+    int product_waiters;
+    int curr_consumer;
+    uint64_t space_signals_sent;        // space_cond signals issued
+
+    // --- Circular buffer ---
+    int message_ready CACHE_ALIGNED;    // only touched with __atomic builtins
+    char message[BUFFER_SIZE][SLOT_LEN] CACHE_ALIGNED;
+
+    /* --- For time measurement --- */
+    sem_t ready_sem CACHE_ALIGNED;
+    sem_t start_gun_sem;
+
+} shared_data;
+
+
+double get_elapsed_seconds(struct timespec start, struct timespec end) {
+    return (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+}
+
+
+// Producer thread function
+void* producer(void* arg) {
+    shared_data *data_ptr = (shared_data*)arg;
+
+    // --- For time measurement ---
+    sem_post(&data_ptr->ready_sem);
+    sem_wait(&data_ptr->start_gun_sem);
+
+    for (int i = 0; i < NUM_PRODUCTS; i++) {
+        if (pthread_mutex_lock(&data_ptr->head_lock) != 0) {
+            perror("pthread_mutex_lock(head_lock)");
+            break;
+        }
+
+        // wait for a space.
+        while (__atomic_load_n(&data_ptr->message_ready, __ATOMIC_ACQUIRE) >= BUFFER_SIZE) {
+            __atomic_add_fetch(&data_ptr->space_waiters, 1, __ATOMIC_SEQ_CST);
+            if (__atomic_load_n(&data_ptr->message_ready, __ATOMIC_SEQ_CST) >= BUFFER_SIZE &&
+                pthread_cond_wait(&data_ptr->space_cond, &data_ptr->head_lock) != 0) {
+                perror("producer cond_wait space fail.");
+            }
+            __atomic_sub_fetch(&data_ptr->space_waiters, 1, __ATOMIC_RELAXED);
+        }
+
+        // write data into the slot; only the producer touches curr_producer.
+        #ifdef DEBUG
+            sprintf(data_ptr->message[data_ptr->curr_producer], "Product:%d", i);
+        #else
+            memcpy(data_ptr->message[data_ptr->curr_producer], template_message, MAX_MESSAGE_LEN);
+        #endif
+        LOG("Producer created: %s\n", data_ptr->message[data_ptr->curr_producer]);
+        data_ptr->curr_producer = (data_ptr->curr_producer + 1) % BUFFER_SIZE;
+        __atomic_add_fetch(&data_ptr->message_ready, 1, __ATOMIC_SEQ_CST);
+
+        if (pthread_mutex_unlock(&data_ptr->head_lock) != 0) {
+            perror("pthread_mutex_unlock(head_lock)");
+            break;
+        }
+
+        // signal only if the consumer is (about to be) asleep.
+        if (__atomic_load_n(&data_ptr->product_waiters, __ATOMIC_SEQ_CST) > 0) {
+            pthread_mutex_lock(&data_ptr->tail_lock);
+            if (pthread_cond_signal(&data_ptr->product_cond) != 0) {
+                perror("pthread_cond_signal for product");
+            }
+            pthread_mutex_unlock(&data_ptr->tail_lock);
+            data_ptr->signals_sent++;
+        }
+    }
+    return NULL;
+}
+
+// Consumer thread function
+void* consumer(void* arg) {
+    shared_data *data_ptr = (shared_data*)arg;
+
+    // --- For time measurement ---
+    sem_post(&data_ptr->ready_sem);
+    sem_wait(&data_ptr->start_gun_sem);
+
+    for (int i = 0; i < NUM_PRODUCTS; i++) {
+        if (pthread_mutex_lock(&data_ptr->tail_lock) != 0) {
+            perror("pthread_mutex_lock(tail_lock)");
+            break;
+        }
+
+        // wait for a product
+        while (__atomic_load_n(&data_ptr->message_ready, __ATOMIC_ACQUIRE) < 1) {
+            __atomic_add_fetch(&data_ptr->product_waiters, 1, __ATOMIC_SEQ_CST);
+            if (__atomic_load_n(&data_ptr->message_ready, __ATOMIC_SEQ_CST) < 1 &&
+                pthread_cond_wait(&data_ptr->product_cond, &data_ptr->tail_lock) != 0) {
+                perror("pthread_cond_wait(product_cond)");
+            }
+            __atomic_sub_fetch(&data_ptr->product_waiters, 1, __ATOMIC_RELAXED);
+        }
+
+        // read data from the slot
+        LOG("Consumer got:   %s\n", data_ptr->message[data_ptr->curr_consumer]);
+        uint64_t total_checksum = 0;
+        for (int j = 0; j < MAX_MESSAGE_LEN; j++) {
+            total_checksum += data_ptr->message[data_ptr->curr_consumer][j];
+        }
+        final_checksum = total_checksum;
+
+        data_ptr->curr_consumer = (data_ptr->curr_consumer + 1) % BUFFER_SIZE;
+        __atomic_sub_fetch(&data_ptr->message_ready, 1, __ATOMIC_SEQ_CST);
+
+        if (pthread_mutex_unlock(&data_ptr->tail_lock) != 0) {
+            perror("pthread_mutex_unlock(tail_lock)");
+            break;
+        }
+
+        // signal only if the producer is (about to be) asleep.
+        if (__atomic_load_n(&data_ptr->space_waiters, __ATOMIC_SEQ_CST) > 0) {
+            pthread_mutex_lock(&data_ptr->head_lock);
+            if (pthread_cond_signal(&data_ptr->space_cond) != 0) {
+                perror("pthread_cond_signal for space");
+            }
+            pthread_mutex_unlock(&data_ptr->head_lock);
+            data_ptr->space_signals_sent++;
+        }
+    }
+    return NULL;
+}
+
+
+int main() {
+    pthread_t producer_thread, consumer_thread;
+    shared_data data;
+
+    data.curr_producer = 0;
+    data.curr_consumer = 0;
+    data.space_waiters = 0;
+    data.product_waiters = 0;
+    data.signals_sent = 0;
+    data.space_signals_sent = 0;
+
+    sem_init(&data.ready_sem, 0, 0); // pshared mode 0:shared between threads, initial value 0.
+    sem_init(&data.start_gun_sem, 0, 0);
+
+    // create the template message for each product
+    memset(template_message, 'A', MAX_MESSAGE_LEN);
+    template_message[MAX_MESSAGE_LEN - 1] = '\0';
+
+
+    // timespec for time measurement.
+    struct timespec start_time, communication_start_time, communication_end_time;
+
+    // start run-time measurement.
+    clock_gettime(CLOCK_MONOTONIC, &start_time);
+
+    // --- Initialize mutexes and condition variables ---
+    if (pthread_mutex_init(&data.head_lock, NULL) != 0 ||
+        pthread_mutex_init(&data.tail_lock, NULL) != 0 ||
+        pthread_cond_init(&data.product_cond, NULL) != 0 ||
+        pthread_cond_init(&data.space_cond, NULL) != 0) {
+        perror("init failed!!");
+        return EXIT_FAILURE;
+    }
+
+    // no product at start.
+    data.message_ready = 0;
+    LOG("pthread mutexes & condvars init OK.\n");
+
+    // create threads
+    if (pthread_create(&producer_thread, NULL, producer, &data) != 0) {
+        perror("pthread_create(producer) failed.");
+        return EXIT_FAILURE;
+    }
+    LOG("pthread_create(producer) success.\n");
+
+    if (pthread_create(&consumer_thread, NULL, consumer, &data) != 0) {
+        perror("pthread_create(consumer) failed.");
+        return EXIT_FAILURE;
+    }
+    LOG("pthread_create(consumer) success.\n");
+
+    // wait until threads are ready.
+    sem_wait(&data.ready_sem);
+    sem_wait(&data.ready_sem);
+
+    // start communication time measurement.
+    clock_gettime(CLOCK_MONOTONIC, &communication_start_time);
+    sem_post(&data.start_gun_sem);
+    sem_post(&data.start_gun_sem);
+
+
+    // --- Wait for threads to complete ---
+    if (pthread_join(producer_thread, NULL) != 0) {
+        perror("pthread_join (producer) failed.");
+        return EXIT_FAILURE;
+    }
+    LOG("producer thread joined.\n");
+
+    if (pthread_join(consumer_thread, NULL) != 0) {
+        perror("pthread_join (consumer) failed.");
+        return EXIT_FAILURE;
+    }
+
+    LOG("consumer thread joined.\n");
+
+    // communication end time measurement.
+    clock_gettime(CLOCK_MONOTONIC, &communication_end_time);
+
+
+    // --- Destroy mutexes and condition variables ---
+    pthread_mutex_destroy(&data.head_lock);
+    pthread_mutex_destroy(&data.tail_lock);
+    pthread_cond_destroy(&data.product_cond);
+    pthread_cond_destroy(&data.space_cond);
+    LOG("pthread mutexes and conds destroyed successfully.\n");
+
+
+    // --- Show measurement result --
+    double initialize_time = get_elapsed_seconds(start_time, communication_start_time);
+    double communication_time = get_elapsed_seconds(communication_start_time, communication_end_time);
+    LOG("Total run time: %.9f seconds\n", initialize_time);
+    LOG("Total communication time: %.9f seconds\n", communication_time);
+    LOG("Signals: %llu product, %llu space for %d messages\n",
+        (unsigned long long)data.signals_sent, (unsigned long long)data.space_signals_sent, NUM_PRODUCTS);
+    printf("%.9f,%.9f\n",initialize_time,communication_time);
+
+
+    // --- Destroy sem use for time measurement ---
+    sem_destroy(&data.ready_sem);
+    sem_destroy(&data.start_gun_sem);
+
+
+    return EXIT_SUCCESS;
+}
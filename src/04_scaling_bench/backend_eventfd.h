@@ -0,0 +1,194 @@
+#ifndef BACKEND_EVENTFD_H
+#define BACKEND_EVENTFD_H
+
+// --- "eventfd" backend ---
+// Messages stay in the shared segment (a bounded MPMC ring, one sequence
+// number per cell as in "spin"); only the "data available" and "space
+// available" notifications go through two eventfds, so a consumer can wait
+// on the ring with epoll alongside its sockets. Here each side sleeps in
+// epoll_wait() on an epoll instance holding its eventfd.
+//
+// Coalescing: a side only writes the other side's eventfd when someone is
+// registered as sleeping there and no notification is already pending
+// (the `signaled` flag), so a burst of messages costs one write() and one
+// wakeup. The woken side drains the eventfd, clears `signaled` and then
+// rescans the ring, which picks up everything sent in between. A woken
+// side takes one message (or slot) and passes the notification on if more
+// are left, so with several consumers (producers) nobody sleeps on a ring
+// that has work for them.
+//
+// The descriptors live in the state block: forked children inherit them,
+// unrelated processes would receive them with SCM_RIGHTS
+// (../common/rendezvous.h).
+
+#include <errno.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include "bench.h"
+
+typedef struct {
+    uint64_t seq;                           // == pos: free for the writer of pos,
+                                            // == pos + 1: holds message pos
+    char data[MAX_MESSAGE_LEN];
+} CACHE_ALIGNED eventfd_cell;
+
+typedef struct {
+    int fd;                                 // eventfd
+    int epoll_fd;                           // epoll instance watching fd
+    uint32_t sleepers CACHE_ALIGNED;        // waiters registered on this side
+    uint32_t signaled;                      // a write is pending, do not write again
+} eventfd_notifier;
+
+typedef struct {
+    uint64_t enqueue_pos CACHE_ALIGNED;
+    uint64_t dequeue_pos CACHE_ALIGNED;
+    eventfd_notifier data CACHE_ALIGNED;    // consumers wait here
+    eventfd_notifier space CACHE_ALIGNED;   // producers wait here
+    eventfd_cell cells[BUFFER_SIZE];
+} eventfd_ring;
+
+static int notifier_init(eventfd_notifier *n){
+    n->sleepers = 0;
+    n->signaled = 0;
+    n->fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if(n->fd == -1){
+        perror("eventfd failed.");
+        return -1;
+    }
+    n->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    struct epoll_event ev = { .events = EPOLLIN, .data.fd = n->fd };
+    if(n->epoll_fd == -1 || epoll_ctl(n->epoll_fd, EPOLL_CTL_ADD, n->fd, &ev) == -1){
+        perror("epoll setup failed.");
+        return -1;
+    }
+    return 0;
+}
+
+static void notifier_destroy(eventfd_notifier *n){
+    close(n->epoll_fd);
+    close(n->fd);
+}
+
+// After publishing: wake the other side if it sleeps and is not already
+// being woken.
+static void notifier_signal(eventfd_notifier *n){
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if(__atomic_load_n(&n->sleepers, __ATOMIC_RELAXED) == 0) return;
+    if(__atomic_exchange_n(&n->signaled, 1, __ATOMIC_SEQ_CST)) return;
+    uint64_t one = 1;
+    if(write(n->fd, &one, sizeof(one)) == -1 && errno != EAGAIN){
+        perror("eventfd write failed.");
+    }
+}
+
+// Sleep until notified, unless ready() turns true once we are registered.
+static void notifier_wait(eventfd_notifier *n, int (*ready)(eventfd_ring *), eventfd_ring *ring){
+    __atomic_fetch_add(&n->sleepers, 1, __ATOMIC_SEQ_CST);
+    if(!ready(ring)){
+        struct epoll_event ev;
+        while(epoll_wait(n->epoll_fd, &ev, 1, -1) == -1 && errno == EINTR){}
+        uint64_t count;
+        // only the waiter that drains the eventfd re-arms it; the others
+        // (EAGAIN) just rescan.
+        if(read(n->fd, &count, sizeof(count)) == sizeof(count)){
+            __atomic_store_n(&n->signaled, 0, __ATOMIC_SEQ_CST);
+        }
+    }
+    __atomic_fetch_sub(&n->sleepers, 1, __ATOMIC_SEQ_CST);
+}
+
+static int eventfd_has_data(eventfd_ring *ring){
+    uint64_t pos = __atomic_load_n(&ring->dequeue_pos, __ATOMIC_SEQ_CST);
+    return __atomic_load_n(&ring->cells[pos % BUFFER_SIZE].seq, __ATOMIC_SEQ_CST) == pos + 1;
+}
+
+static int eventfd_has_space(eventfd_ring *ring){
+    uint64_t pos = __atomic_load_n(&ring->enqueue_pos, __ATOMIC_SEQ_CST);
+    return __atomic_load_n(&ring->cells[pos % BUFFER_SIZE].seq, __ATOMIC_SEQ_CST) == pos;
+}
+
+static size_t eventfd_ring_size(int producers, int consumers){
+    (void)producers;
+    (void)consumers;
+    return sizeof(eventfd_ring);
+}
+
+static int eventfd_ring_init(void *state, int pshared, int producers, int consumers){
+    (void)pshared;
+    (void)producers;
+    (void)consumers;
+    eventfd_ring *ring = state;
+    ring->enqueue_pos = 0;
+    ring->dequeue_pos = 0;
+    for(uint64_t i = 0; i < BUFFER_SIZE; i++){
+        ring->cells[i].seq = i;
+    }
+    if(notifier_init(&ring->data) == -1 || notifier_init(&ring->space) == -1){
+        return -1;
+    }
+    return 0;
+}
+
+static void eventfd_ring_destroy(void *state){
+    eventfd_ring *ring = state;
+    notifier_destroy(&ring->data);
+    notifier_destroy(&ring->space);
+}
+
+static void eventfd_ring_put(void *state, int producer, const char *message, bench_counters *ctr){
+    (void)producer;
+    eventfd_ring *ring = state;
+    uint64_t pos = __atomic_load_n(&ring->enqueue_pos, __ATOMIC_RELAXED);
+    for(;;){
+        eventfd_cell *cell = &ring->cells[pos % BUFFER_SIZE];
+        int64_t diff = (int64_t)(__atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE) - pos);
+        if(diff == 0){
+            if(__atomic_compare_exchange_n(&ring->enqueue_pos, &pos, pos + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)){
+                memcpy(cell->data, message, MAX_MESSAGE_LEN);
+                __atomic_store_n(&cell->seq, pos + 1, __ATOMIC_RELEASE);
+                notifier_signal(&ring->data);
+                if(eventfd_has_space(ring)) notifier_signal(&ring->space);
+                return;
+            }
+        }else if(diff < 0){
+            // full
+            ctr->blocks++;
+            notifier_wait(&ring->space, eventfd_has_space, ring);
+            pos = __atomic_load_n(&ring->enqueue_pos, __ATOMIC_RELAXED);
+        }else{
+            pos = __atomic_load_n(&ring->enqueue_pos, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+static void eventfd_ring_get(void *state, int consumer, char *message, bench_counters *ctr){
+    (void)consumer;
+    eventfd_ring *ring = state;
+    uint64_t pos = __atomic_load_n(&ring->dequeue_pos, __ATOMIC_RELAXED);
+    for(;;){
+        eventfd_cell *cell = &ring->cells[pos % BUFFER_SIZE];
+        int64_t diff = (int64_t)(__atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE) - (pos + 1));
+        if(diff == 0){
+            if(__atomic_compare_exchange_n(&ring->dequeue_pos, &pos, pos + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)){
+                memcpy(message, cell->data, MAX_MESSAGE_LEN);
+                __atomic_store_n(&cell->seq, pos + BUFFER_SIZE, __ATOMIC_RELEASE);
+                notifier_signal(&ring->space);
+                if(eventfd_has_data(ring)) notifier_signal(&ring->data);
+                return;
+            }
+        }else if(diff < 0){
+            // empty
+            ctr->blocks++;
+            notifier_wait(&ring->data, eventfd_has_data, ring);
+            pos = __atomic_load_n(&ring->dequeue_pos, __ATOMIC_RELAXED);
+        }else{
+            pos = __atomic_load_n(&ring->dequeue_pos, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+static const bench_backend eventfd_backend = {
+    "eventfd", eventfd_ring_size, eventfd_ring_init, eventfd_ring_destroy, eventfd_ring_put, eventfd_ring_get
+};
+
+#endif
@@ -0,0 +1,96 @@
+#ifndef BACKEND_MUTEX_H
+#define BACKEND_MUTEX_H
+
+// --- "mutex" backend ---
+// The 03_thread_itc_app design: one mutex, a message count and two
+// condition variables (consumers sleep on product_cond, producers on
+// space_cond).
+
+#include <pthread.h>
+#include "bench.h"
+
+typedef struct {
+    pthread_mutex_t mutex CACHE_ALIGNED;
+    pthread_cond_t product_cond CACHE_ALIGNED;
+    pthread_cond_t space_cond CACHE_ALIGNED;
+    int message_ready CACHE_ALIGNED;
+    int head;
+    int tail;
+    char slots[BUFFER_SIZE][MAX_MESSAGE_LEN] CACHE_ALIGNED;
+} mutex_ring;
+
+static size_t mutex_ring_size(int producers, int consumers){
+    (void)producers;
+    (void)consumers;
+    return sizeof(mutex_ring);
+}
+
+static int mutex_ring_init(void *state, int pshared, int producers, int consumers){
+    (void)producers;
+    (void)consumers;
+    mutex_ring *ring = state;
+    pthread_mutexattr_t mutex_attr;
+    pthread_condattr_t cond_attr;
+    pthread_mutexattr_init(&mutex_attr);
+    pthread_condattr_init(&cond_attr);
+    if(pshared){
+        pthread_mutexattr_setpshared(&mutex_attr, PTHREAD_PROCESS_SHARED);
+        pthread_condattr_setpshared(&cond_attr, PTHREAD_PROCESS_SHARED);
+    }
+    int r = 0;
+    if(pthread_mutex_init(&ring->mutex, &mutex_attr) != 0 ||
+       pthread_cond_init(&ring->product_cond, &cond_attr) != 0 ||
+       pthread_cond_init(&ring->space_cond, &cond_attr) != 0){
+        perror("init failed!!");
+        r = -1;
+    }
+    pthread_mutexattr_destroy(&mutex_attr);
+    pthread_condattr_destroy(&cond_attr);
+    ring->message_ready = 0;
+    ring->head = 0;
+    ring->tail = 0;
+    return r;
+}
+
+static void mutex_ring_destroy(void *state){
+    mutex_ring *ring = state;
+    pthread_mutex_destroy(&ring->mutex);
+    pthread_cond_destroy(&ring->product_cond);
+    pthread_cond_destroy(&ring->space_cond);
+}
+
+static void mutex_ring_put(void *state, int producer, const char *message, bench_counters *ctr){
+    (void)producer;
+    mutex_ring *ring = state;
+    WAIT_COUNTED(pthread_mutex_trylock(&ring->mutex) == 0, pthread_mutex_lock(&ring->mutex), ctr);
+    while(ring->message_ready >= BUFFER_SIZE){
+        ctr->blocks++;
+        pthread_cond_wait(&ring->space_cond, &ring->mutex);
+    }
+    memcpy(ring->slots[ring->head], message, MAX_MESSAGE_LEN);
+    ring->head = (ring->head + 1) % BUFFER_SIZE;
+    ring->message_ready += 1;
+    pthread_cond_signal(&ring->product_cond);
+    pthread_mutex_unlock(&ring->mutex);
+}
+
+static void mutex_ring_get(void *state, int consumer, char *message, bench_counters *ctr){
+    (void)consumer;
+    mutex_ring *ring = state;
+    WAIT_COUNTED(pthread_mutex_trylock(&ring->mutex) == 0, pthread_mutex_lock(&ring->mutex), ctr);
+    while(ring->message_ready < 1){
+        ctr->blocks++;
+        pthread_cond_wait(&ring->product_cond, &ring->mutex);
+    }
+    memcpy(message, ring->slots[ring->tail], MAX_MESSAGE_LEN);
+    ring->tail = (ring->tail + 1) % BUFFER_SIZE;
+    ring->message_ready -= 1;
+    pthread_cond_signal(&ring->space_cond);
+    pthread_mutex_unlock(&ring->mutex);
+}
+
+static const bench_backend mutex_backend = {
+    "mutex", mutex_ring_size, mutex_ring_init, mutex_ring_destroy, mutex_ring_put, mutex_ring_get
+};
+
+#endif
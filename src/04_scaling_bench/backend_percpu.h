@@ -0,0 +1,238 @@
+#ifndef BACKEND_PERCPU_H
+#define BACKEND_PERCPU_H
+
+// --- "percpu" backend ---
+// One SPSC-style ring per possible CPU. A producer pushes into the ring of
+// the CPU it is running on with a restartable sequence (rseq): it checks
+// that it is still on that CPU and that the ring's head is still what it
+// read, copies the message into the slot and commits by storing head + 1,
+// all inside a critical section the kernel restarts (jumps to the abort
+// label) on preemption, signal delivery or migration. No other producer
+// can run on that CPU in between, so the fast path has no atomic
+// read-modify-write and no shared tail.
+//
+// Consumers poll the rings round-robin (a ring is claimed for one pop when
+// there are several consumers) and back off with spin_wait(); there is no
+// futex, since waking one would cost the producer exactly the atomics the
+// rseq path avoids.
+//
+// The rseq area is the one glibc (2.35+) registers for every thread. Where
+// it is not available (registration disabled, older glibc, not x86-64) the
+// producer falls back to sched_getcpu() and a per-ring spinlock.
+//
+// There is a ring for every CPU id up to the highest possible one (capped
+// at PERCPU_MAX_CPUS), plus one overflow ring. A CPU id beyond the cap
+// never gets a ring of its own, and never shares one with an rseq
+// producer: it pushes into the overflow ring under its spinlock.
+
+#include <sched.h>
+#include <stdio.h>
+#include "bench.h"
+
+#if defined(__x86_64__) && defined(__has_include)
+    #if __has_include(<sys/rseq.h>)
+        #include <sys/rseq.h>
+        #define PERCPU_HAVE_RSEQ 1
+    #endif
+#endif
+#ifndef PERCPU_HAVE_RSEQ
+    #define PERCPU_HAVE_RSEQ 0
+#endif
+
+#ifndef PERCPU_MAX_CPUS
+    #define PERCPU_MAX_CPUS 1024
+#endif
+
+typedef struct {
+    // producer side (every producer on this CPU)
+    uint64_t head CACHE_ALIGNED;            // next slot to write
+    int lock;                               // fallback path only
+    // consumer side
+    uint64_t tail CACHE_ALIGNED;            // next slot to read
+    int claimed;
+    char slots[BUFFER_SIZE][MAX_MESSAGE_LEN] CACHE_ALIGNED;
+} percpu_ring;
+
+typedef struct {
+    int consumers;
+    int cpus;                               // per-CPU rings; ring[cpus] is the overflow ring
+    int rings;                              // cpus + 1
+    int use_rseq;
+    int next[MAX_WORKERS];                  // per consumer: ring to poll first
+    percpu_ring ring[] CACHE_ALIGNED;
+} percpu_state;
+
+// Highest possible CPU id + 1, from the kernel's "0-63" / "0,2-5" list;
+// CPU ids can be sparse, so the number of CPUs is not enough.
+static int percpu_cpu_count(void){
+    long cpus = 0;
+    FILE *f = fopen("/sys/devices/system/cpu/possible", "r");
+    if(f != NULL){
+        long id;
+        while(fscanf(f, "%ld", &id) == 1){
+            if(id + 1 > cpus) cpus = id + 1;
+            if(fgetc(f) == EOF) break;      // skip ',' or '-'
+        }
+        fclose(f);
+    }
+    if(cpus < 1) cpus = sysconf(_SC_NPROCESSORS_CONF);
+    if(cpus < 1) cpus = 1;
+    return cpus > PERCPU_MAX_CPUS ? PERCPU_MAX_CPUS : (int)cpus;
+}
+
+#if PERCPU_HAVE_RSEQ
+static inline struct rseq *percpu_rseq_area(void){
+    return (struct rseq *)((char *)__builtin_thread_pointer() + __rseq_offset);
+}
+
+// The critical section: if we are still on `cpu` and *head == expected,
+// copy len bytes from src to dst and store expected + 1 to *head. Returns
+// -1 (without storing) if either check fails or the kernel aborted us.
+static inline int percpu_rseq_push(struct rseq *rs, uint32_t cpu, uint64_t *head, uint64_t expected,
+                                   char *dst, const char *src, size_t len){
+    __asm__ __volatile__ goto(
+        ".pushsection __rseq_cs, \"aw\"\n\t"
+        ".balign 32\n\t"
+        "3:\n\t"
+        ".long 0x0, 0x0\n\t"                        // version, flags
+        ".quad 1f, (2f - 1f), 4f\n\t"               // start_ip, post_commit_offset, abort_ip
+        ".popsection\n\t"
+        "leaq 3b(%%rip), %%rax\n\t"
+        "movq %%rax, %[rseq_cs]\n\t"                // arm the critical section
+        "1:\n\t"
+        "cmpl %[cpu], %[cpu_id]\n\t"
+        "jnz %l[abort]\n\t"
+        "cmpq %[expected], %[head]\n\t"
+        "jnz %l[abort]\n\t"
+        "movq %[dst], %%rdi\n\t"
+        "movq %[src], %%rsi\n\t"
+        "movq %[len], %%rcx\n\t"
+        "rep movsb\n\t"
+        "sfence\n\t"                                // slot bytes before the head
+        "movq %[desired], %[head]\n\t"              // commit
+        "2:\n\t"
+        ".pushsection __rseq_failure, \"ax\"\n\t"
+        ".byte 0x0f, 0xb9, 0x3d\n\t"                // ud1: the signature is not code
+        ".long %c[sig]\n\t"
+        "4:\n\t"
+        "jmp %l[abort]\n\t"
+        ".popsection\n\t"
+        :
+        : [cpu] "r" (cpu), [cpu_id] "m" (rs->cpu_id), [rseq_cs] "m" (rs->rseq_cs),
+          [head] "m" (*head), [expected] "r" (expected), [desired] "r" (expected + 1),
+          [dst] "r" (dst), [src] "r" (src), [len] "r" (len), [sig] "i" (RSEQ_SIG)
+        : "memory", "cc", "rax", "rcx", "rsi", "rdi"
+        : abort);
+    return 0;
+abort:
+    return -1;
+}
+#endif
+
+static size_t percpu_size(int producers, int consumers){
+    (void)producers;
+    (void)consumers;
+    return sizeof(percpu_state) + (size_t)(percpu_cpu_count() + 1) * sizeof(percpu_ring);
+}
+
+static int percpu_init(void *state, int pshared, int producers, int consumers){
+    (void)pshared;
+    percpu_state *st = state;
+    memset(st, 0, percpu_size(producers, consumers));
+    st->consumers = consumers;
+    st->cpus = percpu_cpu_count();
+    st->rings = st->cpus + 1;
+    for(int i = 0; i < consumers; i++){
+        st->next[i] = i % st->rings;
+    }
+#if PERCPU_HAVE_RSEQ
+    // glibc registers rseq for every thread (and forked child) or for none.
+    st->use_rseq = __rseq_size > 0 && (int32_t)percpu_rseq_area()->cpu_id >= 0;
+#endif
+    LOG("percpu: %d + 1 rings, %s\n", st->cpus, st->use_rseq ? "rseq" : "sched_getcpu + spinlock");
+    return 0;
+}
+
+static void percpu_destroy(void *state){
+    (void)state;
+}
+
+static void percpu_put(void *state, int producer, const char *message, bench_counters *ctr){
+    (void)producer;
+    percpu_state *st = state;
+    unsigned spins = 0;
+
+    for(;;){
+#if PERCPU_HAVE_RSEQ
+        struct rseq *rs = st->use_rseq ? percpu_rseq_area() : NULL;
+        uint32_t rseq_cpu = rs ? __atomic_load_n(&rs->cpu_id_start, __ATOMIC_RELAXED) : 0;
+        if(rs && rseq_cpu < (uint32_t)st->cpus){
+            uint32_t cpu = rseq_cpu;
+            percpu_ring *ring = &st->ring[cpu];
+            uint64_t head = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+            if(head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) < BUFFER_SIZE){
+                // a failed push means we were preempted or migrated, or
+                // another producer on this CPU got in first: just retry.
+                if(percpu_rseq_push(rs, cpu, &ring->head, head, ring->slots[head % BUFFER_SIZE],
+                                    message, MAX_MESSAGE_LEN) == 0){
+                    return;
+                }
+                continue;
+            }
+        }else
+#endif
+        {
+            // under rseq only CPU ids beyond the per-CPU rings get here, and
+            // they must stay off those rings: overflow ring.
+            int cpu = st->use_rseq ? st->cpus : sched_getcpu();
+            percpu_ring *ring = &st->ring[cpu >= 0 && cpu < st->cpus ? cpu : st->cpus];
+            while(__atomic_exchange_n(&ring->lock, 1, __ATOMIC_ACQUIRE)) cpu_relax();
+            uint64_t head = ring->head;
+            int full = head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) >= BUFFER_SIZE;
+            if(!full){
+                memcpy(ring->slots[head % BUFFER_SIZE], message, MAX_MESSAGE_LEN);
+                __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+            }
+            __atomic_store_n(&ring->lock, 0, __ATOMIC_RELEASE);
+            if(!full) return;
+        }
+        // this CPU's ring is full.
+        if(spins == 0) ctr->blocks++;
+        spin_wait(&spins);
+    }
+}
+
+static void percpu_get(void *state, int consumer, char *message, bench_counters *ctr){
+    percpu_state *st = state;
+    unsigned spins = 0;
+
+    for(;;){
+        for(int k = 0; k < st->rings; k++){
+            int i = (st->next[consumer] + k) % st->rings;
+            percpu_ring *ring = &st->ring[i];
+            uint64_t tail = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+            if(tail == __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE)) continue;
+            if(st->consumers > 1 && __atomic_exchange_n(&ring->claimed, 1, __ATOMIC_ACQUIRE)) continue;
+
+            tail = ring->tail;
+            int got = tail != __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+            if(got){
+                memcpy(message, ring->slots[tail % BUFFER_SIZE], MAX_MESSAGE_LEN);
+                __atomic_store_n(&ring->tail, tail + 1, __ATOMIC_RELEASE);
+            }
+            if(st->consumers > 1) __atomic_store_n(&ring->claimed, 0, __ATOMIC_RELEASE);
+            if(got){
+                st->next[consumer] = (i + 1) % st->rings;
+                return;
+            }
+        }
+        if(spins == 0) ctr->blocks++;
+        spin_wait(&spins);
+    }
+}
+
+static const bench_backend percpu_backend = {
+    "percpu", percpu_size, percpu_init, percpu_destroy, percpu_put, percpu_get
+};
+
+#endif
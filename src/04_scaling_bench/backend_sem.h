@@ -0,0 +1,74 @@
+#ifndef BACKEND_SEM_H
+#define BACKEND_SEM_H
+
+// --- "sem" backend ---
+// The 02_process_ipc_app design: a binary semaphore around the ring
+// indices plus counting semaphores for free slots and messages.
+
+#include <semaphore.h>
+#include "bench.h"
+
+typedef struct {
+    sem_t lock CACHE_ALIGNED;
+    sem_t space CACHE_ALIGNED;
+    sem_t product CACHE_ALIGNED;
+    int head CACHE_ALIGNED;                 // next slot to write
+    int tail CACHE_ALIGNED;                 // next slot to read
+    char slots[BUFFER_SIZE][MAX_MESSAGE_LEN] CACHE_ALIGNED;
+} sem_ring;
+
+static size_t sem_ring_size(int producers, int consumers){
+    (void)producers;
+    (void)consumers;
+    return sizeof(sem_ring);
+}
+
+static int sem_ring_init(void *state, int pshared, int producers, int consumers){
+    (void)producers;
+    (void)consumers;
+    sem_ring *ring = state;
+    ring->head = 0;
+    ring->tail = 0;
+    if(sem_init(&ring->lock, pshared, 1) == -1 ||
+       sem_init(&ring->space, pshared, BUFFER_SIZE) == -1 ||
+       sem_init(&ring->product, pshared, 0) == -1){
+        perror("sem_init failed.");
+        return -1;
+    }
+    return 0;
+}
+
+static void sem_ring_destroy(void *state){
+    sem_ring *ring = state;
+    sem_destroy(&ring->lock);
+    sem_destroy(&ring->space);
+    sem_destroy(&ring->product);
+}
+
+static void sem_ring_put(void *state, int producer, const char *message, bench_counters *ctr){
+    (void)producer;
+    sem_ring *ring = state;
+    WAIT_COUNTED(sem_trywait(&ring->space) == 0, sem_wait(&ring->space), ctr);
+    WAIT_COUNTED(sem_trywait(&ring->lock) == 0, sem_wait(&ring->lock), ctr);
+    memcpy(ring->slots[ring->head], message, MAX_MESSAGE_LEN);
+    ring->head = (ring->head + 1) % BUFFER_SIZE;
+    sem_post(&ring->lock);
+    sem_post(&ring->product);
+}
+
+static void sem_ring_get(void *state, int consumer, char *message, bench_counters *ctr){
+    (void)consumer;
+    sem_ring *ring = state;
+    WAIT_COUNTED(sem_trywait(&ring->product) == 0, sem_wait(&ring->product), ctr);
+    WAIT_COUNTED(sem_trywait(&ring->lock) == 0, sem_wait(&ring->lock), ctr);
+    memcpy(message, ring->slots[ring->tail], MAX_MESSAGE_LEN);
+    ring->tail = (ring->tail + 1) % BUFFER_SIZE;
+    sem_post(&ring->lock);
+    sem_post(&ring->space);
+}
+
+static const bench_backend sem_backend = {
+    "sem", sem_ring_size, sem_ring_init, sem_ring_destroy, sem_ring_put, sem_ring_get
+};
+
+#endif
@@ -0,0 +1,208 @@
+#ifndef BACKEND_SHARDED_H
+#define BACKEND_SHARDED_H
+
+// --- "sharded" backend ---
+// Fan-in without a shared lock: every producer owns a private SPSC ring
+// (its shard) and only ever touches its own shard's head. Consumers find
+// work through a readiness bitmap, one bit per shard, that producers set
+// after a push and consumers clear when they find the shard empty.
+//
+// Consumers visit ready shards round-robin and take at most SHARD_BATCH
+// messages from one shard before moving on, so one busy producer cannot
+// starve the others. With several consumers a shard is claimed for the
+// duration of one pop (SPSC on both sides); with one consumer the claim is
+// skipped.
+//
+// Sleeping: idle consumers wait on one doorbell futex word, producers bump
+// and wake it only when someone is registered as sleeping. A producer
+// whose shard is full waits on its shard's space_seq futex word.
+
+#include <sched.h>
+#include "bench.h"
+#include "../common/futex.h"
+
+#ifndef SHARD_BATCH
+    #define SHARD_BATCH 8           // messages taken from one shard per visit
+#endif
+#define SHARD_WORDS ((MAX_WORKERS + 63) / 64)
+
+typedef struct {
+    // producer side
+    uint64_t head CACHE_ALIGNED;            // next slot to write
+    uint64_t tail_cache;                    // producer's last view of tail
+    uint32_t producer_waiting;
+    // consumer side
+    uint64_t tail CACHE_ALIGNED;            // next slot to read
+    uint32_t space_seq;                     // futex word, bumped after a pop
+    int claimed;
+    char slots[BUFFER_SIZE][MAX_MESSAGE_LEN] CACHE_ALIGNED;
+} spsc_shard;
+
+typedef struct {
+    int shard;                              // shard being drained
+    int quota;                              // messages left in this visit
+} CACHE_ALIGNED shard_cursor;
+
+typedef struct {
+    int pshared;
+    int producers;
+    int consumers;
+    uint64_t ready[SHARD_WORDS] CACHE_ALIGNED;
+    uint32_t doorbell CACHE_ALIGNED;        // futex word for idle consumers
+    uint32_t sleepers;
+    shard_cursor cursors[MAX_WORKERS];
+    spsc_shard shards[] CACHE_ALIGNED;
+} sharded_state;
+
+static size_t sharded_size(int producers, int consumers){
+    (void)consumers;
+    return sizeof(sharded_state) + (size_t)producers * sizeof(spsc_shard);
+}
+
+static int sharded_init(void *state, int pshared, int producers, int consumers){
+    sharded_state *st = state;
+    memset(st, 0, sharded_size(producers, consumers));
+    st->pshared = pshared;
+    st->producers = producers;
+    st->consumers = consumers;
+    for(int i = 0; i < consumers; i++){
+        st->cursors[i].shard = i % producers;
+    }
+    return 0;
+}
+
+static void sharded_destroy(void *state){
+    (void)state;
+}
+
+// First ready shard at or after `start`, wrapping around; -1 if none.
+static int sharded_next_ready(sharded_state *st, int start){
+    int words = (st->producers + 63) / 64;
+    for(int k = 0; k <= words; k++){
+        int w = (start / 64 + k) % words;
+        uint64_t bits = __atomic_load_n(&st->ready[w], __ATOMIC_ACQUIRE);
+        if(k == 0) bits &= ~0ULL << (start % 64);           // this word, from start on
+        else if(k == words) bits &= ~(~0ULL << (start % 64)); // wrapped: the part before start
+        if(bits) return w * 64 + __builtin_ctzll(bits);
+    }
+    return -1;
+}
+
+static int sharded_any_ready(sharded_state *st){
+    for(int w = 0; w < (st->producers + 63) / 64; w++){
+        if(__atomic_load_n(&st->ready[w], __ATOMIC_SEQ_CST)) return 1;
+    }
+    return 0;
+}
+
+// Pops one message from shard i, or returns 0 if the shard is empty or
+// another consumer holds it.
+static int sharded_pop(sharded_state *st, int i, char *message){
+    spsc_shard *shard = &st->shards[i];
+    uint64_t bit = 1ULL << (i % 64);
+    if(st->consumers > 1 && __atomic_exchange_n(&shard->claimed, 1, __ATOMIC_ACQUIRE)){
+        return 0;
+    }
+    uint64_t tail = shard->tail;
+    if(tail == __atomic_load_n(&shard->head, __ATOMIC_ACQUIRE)){
+        // clear, then look again: a producer that pushed before the clear
+        // saw the bit set and did not set it again.
+        __atomic_fetch_and(&st->ready[i / 64], ~bit, __ATOMIC_SEQ_CST);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        if(tail == __atomic_load_n(&shard->head, __ATOMIC_ACQUIRE)){
+            if(st->consumers > 1) __atomic_store_n(&shard->claimed, 0, __ATOMIC_RELEASE);
+            return 0;
+        }
+        __atomic_fetch_or(&st->ready[i / 64], bit, __ATOMIC_RELEASE);
+    }
+
+    memcpy(message, shard->slots[tail % BUFFER_SIZE], MAX_MESSAGE_LEN);
+    __atomic_store_n(&shard->tail, tail + 1, __ATOMIC_RELEASE);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if(__atomic_load_n(&shard->producer_waiting, __ATOMIC_RELAXED)){
+        __atomic_fetch_add(&shard->space_seq, 1, __ATOMIC_RELEASE);
+        futex_wake(&shard->space_seq, 1, st->pshared);
+    }
+    if(st->consumers > 1) __atomic_store_n(&shard->claimed, 0, __ATOMIC_RELEASE);
+    return 1;
+}
+
+// One round-robin pass over the ready shards.
+static int sharded_take(sharded_state *st, shard_cursor *cursor, char *message){
+    int producers = st->producers;
+    int start = cursor->quota > 0 ? cursor->shard : (cursor->shard + 1) % producers;
+    int scanned = 0;
+    while(scanned < producers){
+        int i = sharded_next_ready(st, start);
+        if(i < 0) return 0;
+        scanned += (i - start + producers) % producers + 1;
+        if(sharded_pop(st, i, message)){
+            if(i != cursor->shard || cursor->quota <= 0){
+                cursor->shard = i;
+                cursor->quota = SHARD_BATCH;
+            }
+            cursor->quota--;
+            return 1;
+        }
+        start = (i + 1) % producers;
+    }
+    return 0;
+}
+
+static void sharded_put(void *state, int producer, const char *message, bench_counters *ctr){
+    sharded_state *st = state;
+    spsc_shard *shard = &st->shards[producer];
+    uint64_t head = shard->head;
+
+    if(head - shard->tail_cache >= BUFFER_SIZE){
+        shard->tail_cache = __atomic_load_n(&shard->tail, __ATOMIC_ACQUIRE);
+        if(head - shard->tail_cache >= BUFFER_SIZE){
+            ctr->blocks++;
+            for(;;){
+                __atomic_store_n(&shard->producer_waiting, 1, __ATOMIC_SEQ_CST);
+                uint32_t seq = __atomic_load_n(&shard->space_seq, __ATOMIC_ACQUIRE);
+                shard->tail_cache = __atomic_load_n(&shard->tail, __ATOMIC_SEQ_CST);
+                if(head - shard->tail_cache < BUFFER_SIZE) break;
+                futex_wait(&shard->space_seq, seq, st->pshared);
+            }
+            __atomic_store_n(&shard->producer_waiting, 0, __ATOMIC_RELAXED);
+        }
+    }
+
+    memcpy(shard->slots[head % BUFFER_SIZE], message, MAX_MESSAGE_LEN);
+    __atomic_store_n(&shard->head, head + 1, __ATOMIC_RELEASE);
+
+    // pairs with the clear-then-recheck in sharded_pop() and with the
+    // register-then-recheck of a consumer going to sleep.
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    uint64_t bit = 1ULL << (producer % 64);
+    if(!(__atomic_load_n(&st->ready[producer / 64], __ATOMIC_RELAXED) & bit)){
+        __atomic_fetch_or(&st->ready[producer / 64], bit, __ATOMIC_SEQ_CST);
+    }
+    if(__atomic_load_n(&st->sleepers, __ATOMIC_SEQ_CST)){
+        __atomic_fetch_add(&st->doorbell, 1, __ATOMIC_RELEASE);
+        futex_wake(&st->doorbell, 1, st->pshared);
+    }
+}
+
+static void sharded_get(void *state, int consumer, char *message, bench_counters *ctr){
+    sharded_state *st = state;
+    shard_cursor *cursor = &st->cursors[consumer];
+
+    while(!sharded_take(st, cursor, message)){
+        ctr->blocks++;
+        __atomic_fetch_add(&st->sleepers, 1, __ATOMIC_SEQ_CST);
+        uint32_t seq = __atomic_load_n(&st->doorbell, __ATOMIC_ACQUIRE);
+        int busy = sharded_any_ready(st);
+        if(!busy) futex_wait(&st->doorbell, seq, st->pshared);
+        __atomic_fetch_sub(&st->sleepers, 1, __ATOMIC_RELAXED);
+        // shards ready but held by other consumers: let them finish.
+        if(busy) sched_yield();
+    }
+}
+
+static const bench_backend sharded_backend = {
+    "sharded", sharded_size, sharded_init, sharded_destroy, sharded_put, sharded_get
+};
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef BACKENDS_H
+#define BACKENDS_H
+
+// Every backend, looked up by name from -b.
+
+#include "bench.h"
+#include "backend_sem.h"
+#include "backend_mutex.h"
+#include "backend_sharded.h"
+#include "backend_spin.h"
+#include "backend_percpu.h"
+#include "backend_eventfd.h"
+
+static const bench_backend *backends[] = {
+    &sem_backend,
+    &mutex_backend,
+    &sharded_backend,
+    &spin_backend,
+    &percpu_backend,
+    &eventfd_backend,
+};
+
+static const bench_backend *backend_by_name(const char *name){
+    for(size_t i = 0; i < sizeof(backends) / sizeof(backends[0]); i++){
+        if(strcmp(backends[i]->name, name) == 0) return backends[i];
+    }
+    return NULL;
+}
+
+#endif
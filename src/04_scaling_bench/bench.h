@@ -0,0 +1,104 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <sched.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#ifdef DEBUG
+    #define LOG(msg, ...) printf(msg, ##__VA_ARGS__);
+#else
+    #define LOG(msg, ...)
+#endif
+
+// --- Buffer setting ---
+#ifndef BUFFER_SIZE
+    #define BUFFER_SIZE 64
+#endif
+#ifndef MAX_MESSAGE_LEN
+    #define MAX_MESSAGE_LEN 64
+#endif
+#ifndef MAX_WORKERS
+    #define MAX_WORKERS 256     // producers + consumers
+#endif
+
+#ifndef CACHE_LINE_SIZE
+    #define CACHE_LINE_SIZE 64
+#endif
+#define CACHE_ALIGNED __attribute__((aligned(CACHE_LINE_SIZE)))
+
+
+// Per-worker contention counters, one cache line each.
+typedef struct {
+    uint64_t messages;
+    uint64_t blocks;        // times the worker had to sleep (or spin) for its turn
+    uint64_t start_ns;      // CLOCK_MONOTONIC, after the start barrier
+    uint64_t end_ns;        // ... and after the last message
+} CACHE_ALIGNED bench_counters;
+
+
+// --- Backend interface ---
+// A backend is a bounded multi-producer/multi-consumer channel whose whole
+// state lives in one block of the shared segment (so it works for threads
+// and for forked processes alike). put()/get() block until they succeed and
+// count every time they had to wait in ctr->blocks.
+typedef struct {
+    const char *name;
+    size_t (*state_size)(int producers, int consumers);
+    int  (*init)(void *state, int pshared, int producers, int consumers);
+    void (*destroy)(void *state);
+    void (*put)(void *state, int producer, const char *message, bench_counters *ctr);
+    void (*get)(void *state, int consumer, char *message, bench_counters *ctr);
+} bench_backend;
+
+
+// Pin the calling thread/process to CPU id % online CPUs.
+// sched_setaffinity() needs _GNU_SOURCE in the includer.
+static inline void pin_worker(int id){
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(id % (cpus > 0 ? cpus : 1), &set);
+    if(sched_setaffinity(0, sizeof(set), &set) == -1){
+        perror("sched_setaffinity failed.");
+    }
+}
+
+// Busy-wait hint for spin loops.
+static inline void cpu_relax(void){
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+// One failed poll of a spin loop: pause for the first SPIN_YIELD_AFTER,
+// then sched_yield() so waiters still make progress when workers
+// outnumber CPUs.
+#ifndef SPIN_YIELD_AFTER
+    #define SPIN_YIELD_AFTER 1000
+#endif
+
+static inline void spin_wait(unsigned *spins){
+    if(++*spins > SPIN_YIELD_AFTER){
+        sched_yield();
+    }else{
+        cpu_relax();
+    }
+}
+
+
+// Try once, then count a block and wait for real.
+#define WAIT_COUNTED(try_expr, wait_expr, ctr)  \
+    do{                                         \
+        if(!(try_expr)){                        \
+            (ctr)->blocks++;                    \
+            wait_expr;                          \
+        }                                       \
+    }while(0)
+
+#endif
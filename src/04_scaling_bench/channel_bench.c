@@ -0,0 +1,300 @@
+#define _GNU_SOURCE // RUSAGE_THREAD
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <stdio.h>     // printf
+#include <stdlib.h>    // macros
+#include <string.h>
+#include <unistd.h>    // fork, getopt
+#include <pthread.h>
+#include "channel_table.h"
+#include "../common/latency_hist.h"
+#include "../common/open_loop.h"   // monotonic_ns, pacer, send stamps
+
+// --- Multiplexed channel benchmark ---
+// One consumer serves C channels of one channel table; P producers each
+// create the channels id % P == producer and send to them in turn, every
+// producer paced at TARGET_RATE messages/s (open loop, see open_loop.h),
+// so the consumer is mostly asleep and every message measures a wakeup.
+//
+//   ./channel_bench [-m thread|process] [-w waitv|doorbell] [-c channels] [-p producers] [-n messages]
+//
+// In the process model the table is a named shm segment that every child
+// attaches to by name; in the thread model it is an anonymous mapping.
+//
+// Output: model,wait,channels,producers,messages,elapsed_s,msgs_per_s,
+//         sleeps_per_msg,consumer_cpu_us_per_msg,
+//         latency_mean,latency_p50,latency_p90,latency_p99,latency_p99.9,latency_max (ns)
+// wait is how the consumer actually slept (waitv-word, waitv-group or
+// doorbell); latency runs from a message's intended send time to the
+// consumer having it, consumer_cpu_us_per_msg is the consumer's own user +
+// system time (scan, futex setup and wakeups) per message.
+//
+// Workers and main meet twice on start_barrier: once the producers have
+// created their channels, and once the consumer has its wait set. A worker
+// whose setup fails sets header->failed and still shows up at both, so
+// nobody is left waiting; everyone checks the flag after the second one.
+
+#define CHANNEL_TABLE_NAME "/channel_bench"
+
+typedef struct {
+    pthread_barrier_t start_barrier;
+    int failed;                         // a worker's setup failed, read after the barriers
+    uint64_t messages;                  // total to send
+    uint64_t consumer_cpu_ns;
+    int wait_mode;                      // what the consumer ended up sleeping on
+    bench_counters counters[MAX_WORKERS + 1];   // producers, then the consumer
+    latency_hist latency;
+} channel_header;
+
+typedef struct {
+    channel_header *header;
+    channel_table *table;               // the creator's mapping (thread model)
+    int process_model;
+    int channels, producers;
+    int use_waitv;
+} channel_config;
+
+typedef struct {
+    channel_config *config;
+    int id;                             // 0..P-1 producers, P the consumer
+} worker_arg;
+
+
+static uint64_t thread_cpu_ns(void){
+    struct rusage usage;
+    getrusage(RUSAGE_THREAD, &usage);
+    return (uint64_t)(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000000ULL +
+           (uint64_t)(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) * 1000ULL;
+}
+
+static channel_table *worker_table(channel_config *config){
+    return config->process_model ? channel_table_attach(CHANNEL_TABLE_NAME) : config->table;
+}
+
+static void run_producer(channel_config *config, channel_table *table, int id){
+    channel_header *header = config->header;
+    bench_counters *ctr = &header->counters[id];
+    int owned = (config->channels - id + config->producers - 1) / config->producers;
+    channel **mine = calloc(owned > 0 ? owned : 1, sizeof(channel *));
+    if(mine == NULL){
+        perror("calloc(channels) failed.");
+        header->failed = 1;
+    }
+    for(int k = 0; table != NULL && mine != NULL && k < owned; k++){
+        mine[k] = channel_create(table, id + k * config->producers);
+        if(mine[k] == NULL){
+            fprintf(stderr, "channel_create(%d) failed.\n", id + k * config->producers);
+            header->failed = 1;
+            break;
+        }
+    }
+    uint64_t messages = header->messages / config->producers +
+                        ((uint64_t)id < header->messages % config->producers);
+
+    char message[MAX_MESSAGE_LEN];
+    memset(message, 'A', MAX_MESSAGE_LEN);
+    // channels created; then the consumer's wait set.
+    pthread_barrier_wait(&header->start_barrier);
+    pthread_barrier_wait(&header->start_barrier);
+    if(header->failed){
+        free(mine);
+        return;
+    }
+
+    open_loop_pacer pacer;
+    pacer_start(&pacer, monotonic_ns());
+    for(uint64_t i = 0; i < messages; i++){
+        write_send_stamp(message, MAX_MESSAGE_LEN, pacer_wait(&pacer));
+        channel_send(table, mine[i % owned], message, ctr);
+        ctr->messages++;
+    }
+    free(mine);
+}
+
+static void run_consumer(channel_config *config, channel_table *table){
+    channel_header *header = config->header;
+    bench_counters *ctr = &header->counters[config->producers];
+    char message[MAX_MESSAGE_LEN];
+
+    // every channel exists once the producers are through the barrier.
+    pthread_barrier_wait(&header->start_barrier);
+    channel_waitset ws;
+    int ready = 0;
+    if(!header->failed){
+        uint32_t *ids = calloc(config->channels, sizeof(uint32_t));
+        if(ids == NULL){
+            perror("calloc(ids) failed.");
+        }else{
+            for(int i = 0; i < config->channels; i++) ids[i] = i;
+            ready = channel_waitset_init(&ws, table, ids, config->channels, config->use_waitv) == 0;
+            free(ids);
+        }
+        if(!ready) header->failed = 1;
+    }
+    pthread_barrier_wait(&header->start_barrier);
+    if(header->failed){
+        if(ready) channel_waitset_destroy(&ws);
+        return;
+    }
+
+    uint64_t cpu_start = thread_cpu_ns();
+    for(uint64_t i = 0; i < header->messages; i++){
+        channel_recv_any(&ws, message, ctr);
+        hist_record(&header->latency, monotonic_ns() - read_send_stamp(message, MAX_MESSAGE_LEN));
+        ctr->messages++;
+    }
+    header->consumer_cpu_ns = thread_cpu_ns() - cpu_start;
+    header->wait_mode = ws.mode;
+    channel_waitset_destroy(&ws);
+}
+
+static void *worker(void *arg){
+    worker_arg *w = arg;
+    channel_config *config = w->config;
+    channel_table *table = worker_table(config);
+    // still take part in the barriers, or the others wait for us forever.
+    if(table == NULL) config->header->failed = 1;
+
+    if(w->id < config->producers){
+        run_producer(config, table, w->id);
+    }else{
+        run_consumer(config, table);
+    }
+    if(config->process_model && table != NULL) channel_table_detach(table);
+    return NULL;
+}
+
+
+int main(int argc, char *argv[])
+{
+    const char *model = "thread";
+    const char *wait = "waitv";
+    channel_config config = { 0 };
+    uint64_t messages = 100000;
+    config.channels = 1;
+    config.producers = 1;
+
+    int opt;
+    while((opt = getopt(argc, argv, "m:w:c:p:n:")) != -1){
+        switch(opt){
+            case 'm': model = optarg; break;
+            case 'w': wait = optarg; break;
+            case 'c': config.channels = atoi(optarg); break;
+            case 'p': config.producers = atoi(optarg); break;
+            case 'n': messages = strtoull(optarg, NULL, 10); break;
+            default:
+                fprintf(stderr, "usage: %s [-m thread|process] [-w waitv|doorbell] [-c channels] [-p producers] [-n messages]\n", argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    config.process_model = strcmp(model, "process") == 0;
+    if(!config.process_model && strcmp(model, "thread") != 0){
+        fprintf(stderr, "unknown model \"%s\" (thread, process)\n", model);
+        return EXIT_FAILURE;
+    }
+    config.use_waitv = strcmp(wait, "waitv") == 0;
+    if(!config.use_waitv && strcmp(wait, "doorbell") != 0){
+        fprintf(stderr, "unknown wait \"%s\" (waitv, doorbell)\n", wait);
+        return EXIT_FAILURE;
+    }
+    if(config.channels < 1 || config.channels > CHANNEL_MAX){
+        fprintf(stderr, "channels must be 1..%d\n", CHANNEL_MAX);
+        return EXIT_FAILURE;
+    }
+    if(config.producers < 1 || config.producers > MAX_WORKERS || config.producers > config.channels){
+        fprintf(stderr, "producers must be 1..min(channels, %d)\n", MAX_WORKERS);
+        return EXIT_FAILURE;
+    }
+    if(MAX_MESSAGE_LEN < SEND_STAMP_LEN){
+        fprintf(stderr, "MAX_MESSAGE_LEN must hold a %zu-byte send stamp\n", SEND_STAMP_LEN);
+        return EXIT_FAILURE;
+    }
+
+    channel_header *header = mmap(NULL, sizeof(channel_header), PROT_READ|PROT_WRITE, MAP_SHARED|MAP_ANONYMOUS, -1, 0);
+    if(header == MAP_FAILED){
+        perror("mmap() failed.");
+        return EXIT_FAILURE;
+    }
+    config.header = header;
+    header->messages = messages;
+    hist_reset(&header->latency);
+
+    config.table = channel_table_create(config.process_model ? CHANNEL_TABLE_NAME : NULL,
+                                        config.channels, config.process_model);
+    if(config.table == NULL) return EXIT_FAILURE;
+
+    int workers = config.producers + 1;
+    pthread_barrierattr_t attr;
+    pthread_barrierattr_init(&attr);
+    if(config.process_model) pthread_barrierattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+    if(pthread_barrier_init(&header->start_barrier, &attr, workers + 1) != 0){
+        perror("pthread_barrier_init() failed.");
+        return EXIT_FAILURE;
+    }
+    pthread_barrierattr_destroy(&attr);
+
+    pthread_t threads[MAX_WORKERS + 1];
+    pid_t pids[MAX_WORKERS + 1];
+    worker_arg args[MAX_WORKERS + 1];
+    for(int i = 0; i < workers; i++){
+        args[i].config = &config;
+        args[i].id = i;
+        if(config.process_model){
+            fflush(NULL);
+            pids[i] = fork();
+            if(pids[i] == -1){
+                perror("fork() failed.");
+                return EXIT_FAILURE;
+            }
+            if(pids[i] == 0){
+                worker(&args[i]);
+                _exit(EXIT_SUCCESS);
+            }
+        }else if(pthread_create(&threads[i], NULL, worker, &args[i]) != 0){
+            perror("pthread_create() failed.");
+            return EXIT_FAILURE;
+        }
+    }
+
+    // channels created, then the wait set: go.
+    pthread_barrier_wait(&header->start_barrier);
+    pthread_barrier_wait(&header->start_barrier);
+    uint64_t start_ns = monotonic_ns();
+    for(int i = 0; i < workers; i++){
+        if(config.process_model){
+            waitpid(pids[i], NULL, 0);
+        }else{
+            pthread_join(threads[i], NULL);
+        }
+    }
+    double elapsed = (monotonic_ns() - start_ns) / 1e9;
+
+    if(header->failed){
+        fprintf(stderr, "channel_bench: worker setup failed.\n");
+        pthread_barrier_destroy(&header->start_barrier);
+        channel_table_detach(config.table);
+        if(config.process_model) shm_unlink(CHANNEL_TABLE_NAME);
+        munmap(header, sizeof(channel_header));
+        return EXIT_FAILURE;
+    }
+
+    bench_counters *consumer = &header->counters[config.producers];
+    if(consumer->messages != messages){
+        fprintf(stderr, "lost messages: sent %llu, received %llu\n",
+                (unsigned long long)messages, (unsigned long long)consumer->messages);
+    }
+
+    printf("%s,%s,%d,%d,%llu,%.9f,%.0f,%.4f,%.3f", model, channel_wait_name(header->wait_mode),
+           config.channels, config.producers, (unsigned long long)messages, elapsed, messages / elapsed,
+           (double)consumer->blocks / messages, header->consumer_cpu_ns / 1e3 / messages);
+    hist_print_csv(&header->latency);
+    printf("\n");
+
+    int ok = consumer->messages == messages;
+    pthread_barrier_destroy(&header->start_barrier);
+    channel_table_detach(config.table);
+    if(config.process_model) shm_unlink(CHANNEL_TABLE_NAME);
+    munmap(header, sizeof(channel_header));
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,389 @@
+#ifndef CHANNEL_TABLE_H
+#define CHANNEL_TABLE_H
+
+// --- Channel table ---
+// Up to CHANNEL_MAX SPSC channels, each with its own BUFFER_SIZE ring, in
+// one shared segment: a named POSIX shm object that other processes attach
+// to (or an anonymous MAP_SHARED one for threads and forked children).
+// Channels are created and attached by ID, so a peer needs the segment
+// name and a number instead of its own segment and semaphore set.
+//
+// A consumer serving many channels builds a channel_waitset and calls
+// channel_recv_any(), which scans the set and, when everything is empty,
+// sleeps on all of it at once:
+//
+//   word      futex_waitv() on every channel's own wakeup word (set of at
+//             most FUTEX_WAITV_MAX channels)
+//   group     futex_waitv() on the wakeup words of the groups of
+//             CHANNEL_GROUP_SIZE channels the set touches (larger sets;
+//             channels of a group outside the set cause spurious wakeups)
+//   doorbell  futex_wait() on the table's one doorbell word, which every
+//             producer rings (kernels without futex_waitv, or on request)
+//
+// A sleeping consumer stores which of the three it sleeps on in each of its
+// channels' `waiting` field, so a producer pays one load per send when
+// nobody sleeps and one futex_wake() on the right word when someone does.
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "bench.h"
+#include "../common/futex.h"
+
+#ifdef FUTEX_WAITV_MAX
+    #define CHANNEL_WAITV_MAX FUTEX_WAITV_MAX
+#else
+    #define CHANNEL_WAITV_MAX 128
+#endif
+#define CHANNEL_GROUP_SIZE 128
+#define CHANNEL_GROUPS CHANNEL_WAITV_MAX
+#define CHANNEL_MAX (CHANNEL_GROUP_SIZE * CHANNEL_GROUPS)
+
+#define CHANNEL_TABLE_MAGIC 0x4348414eU     // "CHAN"
+
+enum { CHANNEL_FREE, CHANNEL_OPEN };
+
+// channel.waiting: what the channel's consumer is asleep on.
+enum { CHANNEL_AWAKE, CHANNEL_WAIT_WORD, CHANNEL_WAIT_GROUP, CHANNEL_WAIT_DOORBELL };
+
+typedef struct {
+    uint32_t state;                         // CHANNEL_FREE / CHANNEL_OPEN
+    uint32_t id;
+    // producer side
+    uint64_t head CACHE_ALIGNED;            // next slot to write
+    uint32_t producer_waiting;
+    // consumer side
+    uint64_t tail CACHE_ALIGNED;            // next slot to read
+    uint32_t space_seq;                     // futex word, bumped after a pop
+    // consumer wakeup
+    uint32_t waiting CACHE_ALIGNED;         // CHANNEL_AWAKE or CHANNEL_WAIT_*
+    uint32_t seq;                           // futex word for CHANNEL_WAIT_WORD
+    char slots[BUFFER_SIZE][MAX_MESSAGE_LEN] CACHE_ALIGNED;
+} channel;
+
+typedef struct {
+    uint32_t seq;                           // futex word for CHANNEL_WAIT_GROUP
+} CACHE_ALIGNED channel_group;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t capacity;                      // channels in the table
+    size_t size;                            // bytes mapped
+    int pshared;
+    uint32_t doorbell CACHE_ALIGNED;        // futex word for CHANNEL_WAIT_DOORBELL
+    channel_group groups[CHANNEL_GROUPS];
+    channel channels[] CACHE_ALIGNED;
+} channel_table;
+
+static inline size_t channel_table_size(uint32_t capacity){
+    return sizeof(channel_table) + (size_t)capacity * sizeof(channel);
+}
+
+
+// --- Segment ---
+
+// Creates a table of `capacity` channels, all free. With a name it is a
+// POSIX shm object (replacing any old one) that channel_table_attach() can
+// open; with NULL an anonymous mapping shared with forked children only.
+static channel_table *channel_table_create(const char *name, uint32_t capacity, int pshared){
+    if(capacity < 1 || capacity > CHANNEL_MAX){
+        fprintf(stderr, "channel table: capacity must be 1..%d\n", CHANNEL_MAX);
+        return NULL;
+    }
+    size_t size = channel_table_size(capacity);
+    void *buffer;
+    if(name == NULL){
+        buffer = mmap(NULL, size, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_ANONYMOUS, -1, 0);
+    }else{
+        shm_unlink(name);
+        int fd = shm_open(name, O_RDWR|O_CREAT|O_EXCL, 0600);
+        if(fd == -1){
+            perror("shm_open(channel table) failed.");
+            return NULL;
+        }
+        if(ftruncate(fd, size) < 0){
+            perror("ftruncate(channel table) failed.");
+            close(fd);
+            shm_unlink(name);
+            return NULL;
+        }
+        buffer = mmap(NULL, size, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+    }
+    if(buffer == MAP_FAILED){
+        perror("mmap(channel table) failed.");
+        if(name != NULL) shm_unlink(name);
+        return NULL;
+    }
+
+    // fresh pages are zero: every channel is CHANNEL_FREE and empty.
+    channel_table *table = buffer;
+    table->capacity = capacity;
+    table->size = size;
+    table->pshared = pshared;
+    __atomic_store_n(&table->magic, CHANNEL_TABLE_MAGIC, __ATOMIC_RELEASE);
+    return table;
+}
+
+static channel_table *channel_table_attach(const char *name){
+    int fd = shm_open(name, O_RDWR, 0600);
+    if(fd == -1){
+        perror("shm_open(channel table) failed.");
+        return NULL;
+    }
+    struct stat st;
+    if(fstat(fd, &st) == -1 || (size_t)st.st_size < sizeof(channel_table)){
+        fprintf(stderr, "channel table: %s is not a channel table\n", name);
+        close(fd);
+        return NULL;
+    }
+    void *buffer = mmap(NULL, st.st_size, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if(buffer == MAP_FAILED){
+        perror("mmap(channel table) failed.");
+        return NULL;
+    }
+    channel_table *table = buffer;
+    if(__atomic_load_n(&table->magic, __ATOMIC_ACQUIRE) != CHANNEL_TABLE_MAGIC ||
+       table->size != (size_t)st.st_size){
+        fprintf(stderr, "channel table: %s is not a channel table\n", name);
+        munmap(buffer, st.st_size);
+        return NULL;
+    }
+    return table;
+}
+
+static void channel_table_detach(channel_table *table){
+    munmap(table, table->size);
+}
+
+
+// --- Channels ---
+
+// Claims channel `id` for a new producer/consumer pair; NULL if the ID is
+// out of range or already open.
+static channel *channel_create(channel_table *table, uint32_t id){
+    if(id >= table->capacity) return NULL;
+    channel *ch = &table->channels[id];
+    uint32_t expected = CHANNEL_FREE;
+    if(!__atomic_compare_exchange_n(&ch->state, &expected, CHANNEL_OPEN, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)){
+        return NULL;
+    }
+    ch->id = id;
+    return ch;
+}
+
+// The open channel `id`, or NULL if it was not created (yet).
+static channel *channel_attach(channel_table *table, uint32_t id){
+    if(id >= table->capacity) return NULL;
+    channel *ch = &table->channels[id];
+    return __atomic_load_n(&ch->state, __ATOMIC_ACQUIRE) == CHANNEL_OPEN ? ch : NULL;
+}
+
+static inline int channel_empty(channel *ch){
+    return __atomic_load_n(&ch->tail, __ATOMIC_RELAXED) == __atomic_load_n(&ch->head, __ATOMIC_ACQUIRE);
+}
+
+// Blocks while the ring is full; counts that in ctr->blocks.
+static void channel_send(channel_table *table, channel *ch, const char *message, bench_counters *ctr){
+    uint64_t head = ch->head;
+    if(head - __atomic_load_n(&ch->tail, __ATOMIC_ACQUIRE) >= BUFFER_SIZE){
+        ctr->blocks++;
+        for(;;){
+            __atomic_store_n(&ch->producer_waiting, 1, __ATOMIC_SEQ_CST);
+            uint32_t seq = __atomic_load_n(&ch->space_seq, __ATOMIC_ACQUIRE);
+            if(head - __atomic_load_n(&ch->tail, __ATOMIC_SEQ_CST) < BUFFER_SIZE) break;
+            futex_wait(&ch->space_seq, seq, table->pshared);
+        }
+        __atomic_store_n(&ch->producer_waiting, 0, __ATOMIC_RELAXED);
+    }
+
+    memcpy(ch->slots[head % BUFFER_SIZE], message, MAX_MESSAGE_LEN);
+    __atomic_store_n(&ch->head, head + 1, __ATOMIC_RELEASE);
+
+    // pairs with the register-then-recheck in channel_sleep().
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    switch(__atomic_load_n(&ch->waiting, __ATOMIC_RELAXED)){
+        case CHANNEL_WAIT_WORD:
+            __atomic_fetch_add(&ch->seq, 1, __ATOMIC_RELEASE);
+            futex_wake(&ch->seq, 1, table->pshared);
+            break;
+        case CHANNEL_WAIT_GROUP: {
+            channel_group *group = &table->groups[ch->id / CHANNEL_GROUP_SIZE];
+            __atomic_fetch_add(&group->seq, 1, __ATOMIC_RELEASE);
+            futex_wake(&group->seq, INT_MAX, table->pshared);
+            break;
+        }
+        case CHANNEL_WAIT_DOORBELL:
+            __atomic_fetch_add(&table->doorbell, 1, __ATOMIC_RELEASE);
+            futex_wake(&table->doorbell, INT_MAX, table->pshared);
+            break;
+    }
+}
+
+// Pops one message, or returns 0 if the ring is empty.
+static int channel_try_recv(channel_table *table, channel *ch, char *message){
+    uint64_t tail = ch->tail;
+    if(tail == __atomic_load_n(&ch->head, __ATOMIC_ACQUIRE)) return 0;
+
+    memcpy(message, ch->slots[tail % BUFFER_SIZE], MAX_MESSAGE_LEN);
+    __atomic_store_n(&ch->tail, tail + 1, __ATOMIC_RELEASE);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if(__atomic_load_n(&ch->producer_waiting, __ATOMIC_RELAXED)){
+        __atomic_fetch_add(&ch->space_seq, 1, __ATOMIC_RELEASE);
+        futex_wake(&ch->space_seq, 1, table->pshared);
+    }
+    return 1;
+}
+
+
+// --- Wait-any ---
+
+typedef struct {
+    channel_table *table;
+    channel **channels;
+    int count;
+    int next;                               // channel to scan first
+    int mode;                               // CHANNEL_WAIT_*
+    int groups;                             // distinct groups (CHANNEL_WAIT_GROUP)
+    uint32_t *group_ids;
+#if FUTEX_HAVE_WAITV
+    struct futex_waitv *waiters;
+#endif
+} channel_waitset;
+
+static const char *channel_wait_name(int mode){
+    switch(mode){
+        case CHANNEL_WAIT_WORD:  return "waitv-word";
+        case CHANNEL_WAIT_GROUP: return "waitv-group";
+        default:                 return "doorbell";
+    }
+}
+
+static void channel_waitset_destroy(channel_waitset *ws){
+    free(ws->channels);
+    free(ws->group_ids);
+#if FUTEX_HAVE_WAITV
+    free(ws->waiters);
+#endif
+}
+
+// A wait set over the open channels ids[0..count). use_waitv = 0 forces the
+// doorbell. Returns -1 (with nothing left allocated) if a channel is not
+// open or on allocation failure.
+static int channel_waitset_init(channel_waitset *ws, channel_table *table, const uint32_t *ids, int count, int use_waitv){
+    memset(ws, 0, sizeof(*ws));
+    ws->table = table;
+    ws->count = count;
+    ws->channels = calloc(count, sizeof(channel *));
+    ws->group_ids = calloc(CHANNEL_GROUPS, sizeof(uint32_t));
+    if(ws->channels == NULL || ws->group_ids == NULL){
+        perror("calloc(channel_waitset) failed.");
+        channel_waitset_destroy(ws);
+        return -1;
+    }
+
+    uint64_t seen[CHANNEL_GROUPS / 64] = { 0 };
+    for(int i = 0; i < count; i++){
+        ws->channels[i] = channel_attach(table, ids[i]);
+        if(ws->channels[i] == NULL){
+            fprintf(stderr, "channel %u is not open\n", ids[i]);
+            channel_waitset_destroy(ws);
+            return -1;
+        }
+        uint32_t group = ids[i] / CHANNEL_GROUP_SIZE;
+        if(!(seen[group / 64] & (1ULL << (group % 64)))){
+            seen[group / 64] |= 1ULL << (group % 64);
+            ws->group_ids[ws->groups++] = group;
+        }
+    }
+
+    ws->mode = CHANNEL_WAIT_DOORBELL;
+#if FUTEX_HAVE_WAITV
+    if(use_waitv){
+        ws->mode = count <= CHANNEL_WAITV_MAX ? CHANNEL_WAIT_WORD : CHANNEL_WAIT_GROUP;
+        ws->waiters = calloc(CHANNEL_WAITV_MAX, sizeof(struct futex_waitv));
+        if(ws->waiters == NULL){
+            perror("calloc(futex_waitv) failed.");
+            channel_waitset_destroy(ws);
+            return -1;
+        }
+    }
+#else
+    (void)use_waitv;
+#endif
+    return 0;
+}
+
+static int channel_any_ready(channel_waitset *ws){
+    for(int i = 0; i < ws->count; i++){
+        if(!channel_empty(ws->channels[i])) return 1;
+    }
+    return 0;
+}
+
+// Registers as asleep on every channel of the set, rechecks them and
+// sleeps on whatever ws->mode says. Returns after a wakeup or at once if a
+// message turned up; falls back to the doorbell for good if the kernel has
+// no futex_waitv.
+static void channel_sleep(channel_waitset *ws){
+    channel_table *table = ws->table;
+    int mode = ws->mode;
+    for(int i = 0; i < ws->count; i++){
+        __atomic_store_n(&ws->channels[i]->waiting, mode, __ATOMIC_SEQ_CST);
+    }
+
+    uint32_t doorbell = __atomic_load_n(&table->doorbell, __ATOMIC_ACQUIRE);
+#if FUTEX_HAVE_WAITV
+    int n = 0;
+    if(mode == CHANNEL_WAIT_WORD){
+        for(n = 0; n < ws->count; n++){
+            channel *ch = ws->channels[n];
+            futex_waitv_set(&ws->waiters[n], &ch->seq, __atomic_load_n(&ch->seq, __ATOMIC_ACQUIRE), table->pshared);
+        }
+    }else if(mode == CHANNEL_WAIT_GROUP){
+        for(n = 0; n < ws->groups; n++){
+            channel_group *group = &table->groups[ws->group_ids[n]];
+            futex_waitv_set(&ws->waiters[n], &group->seq, __atomic_load_n(&group->seq, __ATOMIC_ACQUIRE), table->pshared);
+        }
+    }
+#endif
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    if(!channel_any_ready(ws)){
+#if FUTEX_HAVE_WAITV
+        if(mode != CHANNEL_WAIT_DOORBELL){
+            if(futex_waitv(ws->waiters, n) == -1 && errno == ENOSYS){
+                ws->mode = CHANNEL_WAIT_DOORBELL;
+            }
+        }else
+#endif
+        futex_wait(&table->doorbell, doorbell, table->pshared);
+    }
+
+    for(int i = 0; i < ws->count; i++){
+        __atomic_store_n(&ws->channels[i]->waiting, CHANNEL_AWAKE, __ATOMIC_RELAXED);
+    }
+}
+
+// Blocks until a message arrives on any channel of the set and returns the
+// channel it came from. Channels are scanned round-robin from the one
+// after the last hit; every sleep is counted in ctr->blocks.
+static channel *channel_recv_any(channel_waitset *ws, char *message, bench_counters *ctr){
+    for(;;){
+        for(int k = 0; k < ws->count; k++){
+            int i = (ws->next + k) % ws->count;
+            if(channel_try_recv(ws->table, ws->channels[i], message)){
+                ws->next = (i + 1) % ws->count;
+                return ws->channels[i];
+            }
+        }
+        ctr->blocks++;
+        channel_sleep(ws);
+    }
+}
+
+#endif
@@ -0,0 +1,383 @@
+#define _GNU_SOURCE // sched_setaffinity, CPU_SET
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <errno.h>
+#include <stdio.h>     // printf
+#include <stdlib.h>    // macros
+#include <string.h>
+#include <unistd.h>    // fork, getopt
+#include <pthread.h>
+#include "backends.h"
+#include "../common/latency_hist.h"
+#include "../common/open_loop.h"   // monotonic_ns, pacer, send stamps
+#include "../common/workload.h"
+
+// --- Elastic consumer pool ---
+// A supervisor process watches the backlog of one backend's queue and
+// forks or retires consumer processes between `min` and `max` while a
+// bursty open-loop producer feeds it: `base` messages/s, `burst`
+// messages/s for the first burst_ms of every period_ms.
+//
+//   ./elastic_bench [-b backend] [-k min,max] [-d seconds] [-r base,burst]
+//                   [-B burst_ms,period_ms] [-t tick_ms] [-v]
+//
+//   -v  also print the timeline: one line per tick and one per scale event
+//       tick,<ms>,<consumers>,<backlog>,<messages>,<lat_mean>,<lat_p50>,<lat_p99>
+//       scale,<ms>,up|down,<consumers>,<backlog>
+//
+// Joining is just a fork: the new consumer blocks in get() on the same
+// queue like the others, in a free consumer slot. Leaving is a poison pill
+// (a message with send stamp 0) that the supervisor puts into the queue:
+// whichever consumer takes it exits between messages, so nobody leaves
+// with a message in hand. The backlog is messages sent (queued or about
+// to be) minus messages consumed, read from the shared header every
+// tick_ms:
+//   backlog >= ELASTIC_HIGH_WATER                  -> one more consumer
+//   backlog <= ELASTIC_LOW_WATER for ELASTIC_IDLE_TICKS ticks -> one fewer
+//
+// Consumers run the WORKLOAD (see ../common/workload.h, default spin:20000)
+// on every message.
+//
+// Output: backend,min,max,messages,elapsed_s,scale_ups,scale_downs,
+//         avg_consumers,max_backlog,
+//         latency_mean,latency_p50,latency_p90,latency_p99,latency_p99.9,latency_max (ns)
+
+#ifndef ELASTIC_MAX_CONSUMERS
+    #define ELASTIC_MAX_CONSUMERS 64
+#endif
+#ifndef ELASTIC_HIGH_WATER
+    #define ELASTIC_HIGH_WATER (BUFFER_SIZE / 2)
+#endif
+#ifndef ELASTIC_LOW_WATER
+    #define ELASTIC_LOW_WATER 1
+#endif
+#ifndef ELASTIC_IDLE_TICKS
+    #define ELASTIC_IDLE_TICKS 20
+#endif
+
+#define PRODUCER_ID 0
+#define SUPERVISOR_ID 1         // puts the poison pills
+
+typedef struct {
+    pthread_barrier_t start_barrier;    // producer and supervisor
+    uint64_t duration_ns;
+    double base_rate, burst_rate;
+    uint64_t burst_ns, period_ns;
+    uint64_t sent CACHE_ALIGNED;        // producer
+    int producer_done;
+    uint64_t received CACHE_ALIGNED;    // all consumers
+    bench_counters counters[ELASTIC_MAX_CONSUMERS + 2];
+    latency_hist latency[ELASTIC_MAX_CONSUMERS];    // one per consumer slot
+} elastic_header;
+
+enum { SLOT_FREE, SLOT_ACTIVE, SLOT_RETIRING };
+
+typedef struct {
+    const bench_backend *backend;
+    elastic_header *header;
+    void *state;
+    workload work;
+    int state_of[ELASTIC_MAX_CONSUMERS];
+    pid_t pid_of[ELASTIC_MAX_CONSUMERS];
+    int active;                         // consumers not yet sent a pill
+} elastic_pool;
+
+
+static void run_producer(elastic_pool *pool){
+    elastic_header *header = pool->header;
+    bench_counters *ctr = &header->counters[ELASTIC_MAX_CONSUMERS];
+    char message[MAX_MESSAGE_LEN];
+    memset(message, 'A', MAX_MESSAGE_LEN);
+
+    pthread_barrier_wait(&header->start_barrier);
+    open_loop_pacer pacer;
+    uint64_t start_ns = monotonic_ns();
+    pacer_start(&pacer, start_ns);
+    for(;;){
+        uint64_t t = pacer.next_ns - start_ns;
+        if(t >= header->duration_ns) break;
+        pacer_set_rate(&pacer, t % header->period_ns < header->burst_ns ? header->burst_rate : header->base_rate);
+        write_send_stamp(message, MAX_MESSAGE_LEN, pacer_wait(&pacer));
+        // counted before the put, so sent >= received at all times.
+        __atomic_store_n(&header->sent, header->sent + 1, __ATOMIC_RELEASE);
+        pool->backend->put(pool->state, PRODUCER_ID, message, ctr);
+        ctr->messages++;
+    }
+    __atomic_store_n(&header->producer_done, 1, __ATOMIC_RELEASE);
+}
+
+static void run_consumer(elastic_pool *pool, int slot){
+    elastic_header *header = pool->header;
+    bench_counters *ctr = &header->counters[slot];
+    char message[MAX_MESSAGE_LEN];
+    volatile uint64_t checksum;
+
+    for(;;){
+        pool->backend->get(pool->state, slot, message, ctr);
+        uint64_t stamp = read_send_stamp(message, MAX_MESSAGE_LEN);
+        if(stamp == 0) break;           // poison pill: leave the pool
+        checksum = pool->work.run(&pool->work, message, MAX_MESSAGE_LEN);
+        hist_record(&header->latency[slot], monotonic_ns() - stamp);
+        ctr->messages++;
+        __atomic_fetch_add(&header->received, 1, __ATOMIC_RELEASE);
+    }
+    (void)checksum;
+}
+
+
+// Fork a consumer into a free slot; -1 if there is none or fork failed.
+static int pool_grow(elastic_pool *pool){
+    for(int slot = 0; slot < ELASTIC_MAX_CONSUMERS; slot++){
+        if(pool->state_of[slot] != SLOT_FREE) continue;
+        fflush(NULL);
+        pid_t pid = fork();
+        if(pid == -1){
+            perror("fork() failed.");
+            return -1;
+        }
+        if(pid == 0){
+            run_consumer(pool, slot);
+            _exit(EXIT_SUCCESS);
+        }
+        pool->state_of[slot] = SLOT_ACTIVE;
+        pool->pid_of[slot] = pid;
+        pool->active++;
+        return 0;
+    }
+    return -1;
+}
+
+// Send one poison pill; the slot is freed when its consumer is reaped.
+static void pool_shrink(elastic_pool *pool){
+    char pill[MAX_MESSAGE_LEN];
+    memset(pill, 0, MAX_MESSAGE_LEN);
+    pool->backend->put(pool->state, SUPERVISOR_ID, pill, &pool->header->counters[ELASTIC_MAX_CONSUMERS + 1]);
+    // any consumer may take it; count one as leaving.
+    for(int slot = 0; slot < ELASTIC_MAX_CONSUMERS; slot++){
+        if(pool->state_of[slot] == SLOT_ACTIVE){
+            pool->state_of[slot] = SLOT_RETIRING;
+            break;
+        }
+    }
+    pool->active--;
+}
+
+// Reap exited consumers. A pill taken by another consumer than the one
+// marked retiring just swaps their roles: the marks only count.
+static int pool_reap(elastic_pool *pool, int block){
+    int reaped = 0;
+    pid_t pid;
+    while((pid = waitpid(-1, NULL, block ? 0 : WNOHANG)) > 0){
+        for(int slot = 0; slot < ELASTIC_MAX_CONSUMERS; slot++){
+            if(pool->pid_of[slot] != pid || pool->state_of[slot] == SLOT_FREE) continue;
+            if(pool->state_of[slot] == SLOT_ACTIVE){
+                for(int other = 0; other < ELASTIC_MAX_CONSUMERS; other++){
+                    if(pool->state_of[other] == SLOT_RETIRING){
+                        pool->state_of[other] = SLOT_ACTIVE;
+                        break;
+                    }
+                }
+            }
+            pool->state_of[slot] = SLOT_FREE;
+            reaped++;
+        }
+        if(block) break;
+    }
+    return reaped;
+}
+
+// Latency recorded since `prev` over all slots, into `delta`; prev catches up.
+static void latency_since(elastic_header *header, latency_hist *prev, latency_hist *delta){
+    static latency_hist total;
+    hist_reset(&total);
+    for(int slot = 0; slot < ELASTIC_MAX_CONSUMERS; slot++){
+        hist_merge(&total, &header->latency[slot]);
+    }
+    hist_reset(delta);
+    for(int i = 0; i < HIST_BUCKETS; i++){
+        delta->buckets[i] = total.buckets[i] - prev->buckets[i];
+        delta->count += delta->buckets[i];
+    }
+    delta->sum_ns = total.sum_ns - prev->sum_ns;
+    *prev = total;
+}
+
+
+int main(int argc, char *argv[])
+{
+    const char *backend_name = "sem";
+    int min_consumers = 1, max_consumers = 8;
+    double seconds = 5, base_rate = 5000, burst_rate = 50000;
+    double burst_ms = 500, period_ms = 2000, tick_ms = 10;
+    int verbose = 0;
+
+    int opt;
+    while((opt = getopt(argc, argv, "b:k:d:r:B:t:v")) != -1){
+        switch(opt){
+            case 'b': backend_name = optarg; break;
+            case 'k': sscanf(optarg, "%d,%d", &min_consumers, &max_consumers); break;
+            case 'd': seconds = atof(optarg); break;
+            case 'r': sscanf(optarg, "%lf,%lf", &base_rate, &burst_rate); break;
+            case 'B': sscanf(optarg, "%lf,%lf", &burst_ms, &period_ms); break;
+            case 't': tick_ms = atof(optarg); break;
+            case 'v': verbose = 1; break;
+            default:
+                fprintf(stderr, "usage: %s [-b backend] [-k min,max] [-d seconds] [-r base,burst] "
+                                "[-B burst_ms,period_ms] [-t tick_ms] [-v]\n", argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    elastic_pool pool = { 0 };
+    pool.backend = backend_by_name(backend_name);
+    if(pool.backend == NULL){
+        fprintf(stderr, "unknown backend \"%s\"\n", backend_name);
+        return EXIT_FAILURE;
+    }
+    if(min_consumers < 1 || max_consumers < min_consumers || max_consumers > ELASTIC_MAX_CONSUMERS ||
+       max_consumers > MAX_WORKERS){
+        fprintf(stderr, "need 1 <= min <= max <= %d\n", ELASTIC_MAX_CONSUMERS < MAX_WORKERS ? ELASTIC_MAX_CONSUMERS : MAX_WORKERS);
+        return EXIT_FAILURE;
+    }
+    if(base_rate <= 0 || burst_rate <= 0 || period_ms <= 0 || tick_ms <= 0){
+        fprintf(stderr, "rates, period and tick must be > 0\n");
+        return EXIT_FAILURE;
+    }
+    if(MAX_MESSAGE_LEN < SEND_STAMP_LEN){
+        fprintf(stderr, "MAX_MESSAGE_LEN must hold a %zu-byte send stamp\n", SEND_STAMP_LEN);
+        return EXIT_FAILURE;
+    }
+    if(workload_from_env(&pool.work, "WORKLOAD", "spin:20000") == -1){
+        return EXIT_FAILURE;
+    }
+
+    size_t header_size = (sizeof(elastic_header) + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE * CACHE_LINE_SIZE;
+    size_t segment_size = header_size + pool.backend->state_size(2, max_consumers);
+    void *buffer = mmap(NULL, segment_size, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_ANONYMOUS, -1, 0);
+    if(buffer == MAP_FAILED){
+        perror("mmap() failed.");
+        return EXIT_FAILURE;
+    }
+    elastic_header *header = buffer;
+    pool.header = header;
+    pool.state = (char *)buffer + header_size;
+    header->duration_ns = (uint64_t)(seconds * 1e9);
+    header->base_rate = base_rate;
+    header->burst_rate = burst_rate;
+    header->burst_ns = (uint64_t)(burst_ms * 1e6);
+    header->period_ns = (uint64_t)(period_ms * 1e6);
+    for(int slot = 0; slot < ELASTIC_MAX_CONSUMERS; slot++){
+        hist_reset(&header->latency[slot]);
+    }
+
+    pthread_barrierattr_t attr;
+    pthread_barrierattr_init(&attr);
+    pthread_barrierattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+    if(pthread_barrier_init(&header->start_barrier, &attr, 2) != 0){
+        perror("pthread_barrier_init() failed.");
+        return EXIT_FAILURE;
+    }
+    pthread_barrierattr_destroy(&attr);
+    if(pool.backend->init(pool.state, 1, 2, max_consumers) == -1){
+        return EXIT_FAILURE;
+    }
+
+    for(int i = 0; i < min_consumers; i++){
+        if(pool_grow(&pool) == -1) return EXIT_FAILURE;
+    }
+    fflush(NULL);
+    pid_t producer_pid = fork();
+    if(producer_pid == -1){
+        perror("fork() failed.");
+        return EXIT_FAILURE;
+    }
+    if(producer_pid == 0){
+        run_producer(&pool);
+        _exit(EXIT_SUCCESS);
+    }
+
+    // --- Supervisor ---
+    static latency_hist seen, tick_latency;
+    hist_reset(&seen);
+    uint64_t tick_ns = (uint64_t)(tick_ms * 1e6);
+    uint64_t ups = 0, downs = 0, ticks = 0, consumer_ticks = 0, max_backlog = 0;
+    int idle_ticks = 0;
+
+    pthread_barrier_wait(&header->start_barrier);
+    uint64_t start_ns = monotonic_ns();
+    uint64_t next_ns = start_ns;
+    for(;;){
+        next_ns += tick_ns;
+        struct timespec ts = { .tv_sec = (time_t)(next_ns / 1000000000ULL), .tv_nsec = (long)(next_ns % 1000000000ULL) };
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+        pool_reap(&pool, 0);
+
+        int done = __atomic_load_n(&header->producer_done, __ATOMIC_ACQUIRE);
+        uint64_t received = __atomic_load_n(&header->received, __ATOMIC_ACQUIRE);
+        uint64_t backlog = __atomic_load_n(&header->sent, __ATOMIC_ACQUIRE) - received;
+        if(done && backlog == 0) break;
+        uint64_t now_ms = (monotonic_ns() - start_ns) / 1000000;
+
+        if(backlog > max_backlog) max_backlog = backlog;
+        idle_ticks = backlog <= ELASTIC_LOW_WATER ? idle_ticks + 1 : 0;
+        if(backlog >= ELASTIC_HIGH_WATER && pool.active < max_consumers){
+            if(pool_grow(&pool) == 0){
+                ups++;
+                if(verbose) printf("scale,%llu,up,%d,%llu\n", (unsigned long long)now_ms, pool.active, (unsigned long long)backlog);
+            }
+        }else if(idle_ticks >= ELASTIC_IDLE_TICKS && pool.active > min_consumers){
+            pool_shrink(&pool);
+            downs++;
+            idle_ticks = 0;
+            if(verbose) printf("scale,%llu,down,%d,%llu\n", (unsigned long long)now_ms, pool.active, (unsigned long long)backlog);
+        }
+
+        ticks++;
+        consumer_ticks += pool.active;
+        if(verbose){
+            latency_since(header, &seen, &tick_latency);
+            printf("tick,%llu,%d,%llu,%llu,%.0f,%llu,%llu\n", (unsigned long long)now_ms, pool.active,
+                   (unsigned long long)backlog, (unsigned long long)tick_latency.count, hist_mean(&tick_latency),
+                   (unsigned long long)hist_percentile(&tick_latency, 50.0),
+                   (unsigned long long)hist_percentile(&tick_latency, 99.0));
+        }
+    }
+    double elapsed = (monotonic_ns() - start_ns) / 1e9;
+
+    // --- Shutdown: one pill per remaining consumer ---
+    waitpid(producer_pid, NULL, 0);
+    while(pool.active > 0){
+        pool_shrink(&pool);
+    }
+    int remaining = 0;
+    for(int slot = 0; slot < ELASTIC_MAX_CONSUMERS; slot++){
+        if(pool.state_of[slot] != SLOT_FREE) remaining++;
+    }
+    while(remaining > 0){
+        errno = 0;
+        int reaped = pool_reap(&pool, 1);
+        if(reaped == 0 && errno == ECHILD) break;
+        remaining -= reaped;
+    }
+
+    latency_hist total;
+    hist_reset(&total);
+    for(int slot = 0; slot < ELASTIC_MAX_CONSUMERS; slot++){
+        hist_merge(&total, &header->latency[slot]);
+    }
+    uint64_t sent = header->sent;
+    if(total.count != sent){
+        fprintf(stderr, "lost messages: sent %llu, consumed %llu\n",
+                (unsigned long long)sent, (unsigned long long)total.count);
+    }
+
+    printf("%s,%d,%d,%llu,%.9f,%llu,%llu,%.3f,%llu", pool.backend->name, min_consumers, max_consumers,
+           (unsigned long long)sent, elapsed, (unsigned long long)ups, (unsigned long long)downs,
+           ticks ? (double)consumer_ticks / ticks : (double)min_consumers, (unsigned long long)max_backlog);
+    hist_print_csv(&total);
+    printf("\n");
+
+    pool.backend->destroy(pool.state);
+    pthread_barrier_destroy(&header->start_barrier);
+    munmap(buffer, segment_size);
+    return total.count == sent ? EXIT_SUCCESS : EXIT_FAILURE;
+}
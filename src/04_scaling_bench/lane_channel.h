@@ -0,0 +1,230 @@
+#ifndef LANE_CHANNEL_H
+#define LANE_CHANNEL_H
+
+// --- Multi-lane channel ---
+// One channel, three SPSC rings ("lanes") with their own slot size and
+// depth: small urgent messages on LANE_HIGH, regular traffic on
+// LANE_NORMAL, large transfers on LANE_BULK. There is one producer per
+// lane and one consumer for all of them, and a single wake mechanism: the
+// consumer sleeps on one doorbell futex word that every lane rings.
+//
+// Consumer policies:
+//   LANE_PRIORITY  always take the highest non-empty lane, except that a
+//                  lower lane that was passed over lane_starve[] times in a
+//                  row while it had messages gets the next turn
+//   LANE_FIFO      take the lane whose oldest message was sent first, which
+//                  is what one shared ring would do (the baseline)
+//
+// LANE_FIFO orders by the send stamp (../common/open_loop.h) in the last
+// bytes of every message, so producers must write one.
+
+#include <limits.h>
+#include "bench.h"
+#include "../common/futex.h"
+#include "../common/open_loop.h"   // read_send_stamp
+
+#define LANES 3
+enum { LANE_HIGH, LANE_NORMAL, LANE_BULK };
+enum { LANE_PRIORITY, LANE_FIFO };
+
+#ifndef LANE_HIGH_LEN
+    #define LANE_HIGH_LEN 256
+#endif
+#ifndef LANE_HIGH_SLOTS
+    #define LANE_HIGH_SLOTS 16
+#endif
+#ifndef LANE_NORMAL_LEN
+    #define LANE_NORMAL_LEN 4096
+#endif
+#ifndef LANE_NORMAL_SLOTS
+    #define LANE_NORMAL_SLOTS 64
+#endif
+#ifndef LANE_BULK_LEN
+    #define LANE_BULK_LEN 65536
+#endif
+#ifndef LANE_BULK_SLOTS
+    #define LANE_BULK_SLOTS 128
+#endif
+
+// Starvation limits: a lane with messages is passed over at most this many
+// times in a row for higher lanes before it is served once.
+#ifndef LANE_NORMAL_STARVE
+    #define LANE_NORMAL_STARVE 8
+#endif
+#ifndef LANE_BULK_STARVE
+    #define LANE_BULK_STARVE 32
+#endif
+
+#define LANE_MAX_LEN LANE_BULK_LEN
+
+static const char *lane_names[LANES] = { "high", "normal", "bulk" };
+static const uint32_t lane_len[LANES] = { LANE_HIGH_LEN, LANE_NORMAL_LEN, LANE_BULK_LEN };
+static const uint32_t lane_slots[LANES] = { LANE_HIGH_SLOTS, LANE_NORMAL_SLOTS, LANE_BULK_SLOTS };
+static const uint32_t lane_starve[LANES] = { 0, LANE_NORMAL_STARVE, LANE_BULK_STARVE };
+
+typedef struct {
+    // producer side
+    uint64_t head CACHE_ALIGNED;            // next slot to write
+    uint32_t producer_waiting;
+    // consumer side
+    uint64_t tail CACHE_ALIGNED;            // next slot to read
+    uint32_t space_seq;                     // futex word, bumped after a pop
+    uint32_t passed;                        // times skipped in a row (consumer only)
+    size_t data;                            // slots, as an offset from the channel
+} lane_ring;
+
+typedef struct {
+    int pshared;
+    int policy;
+    uint32_t doorbell CACHE_ALIGNED;        // futex word the consumer sleeps on
+    uint32_t consumer_waiting;
+    uint32_t open_producers;                // lane_close() counts this down
+    lane_ring lanes[LANES];
+} lane_channel;
+
+static size_t lane_channel_size(void){
+    size_t size = (sizeof(lane_channel) + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE * CACHE_LINE_SIZE;
+    for(int i = 0; i < LANES; i++){
+        size += (size_t)lane_slots[i] * lane_len[i];
+    }
+    return size;
+}
+
+static int lane_channel_init(lane_channel *ch, int pshared, int policy, int producers){
+    memset(ch, 0, sizeof(*ch));
+    ch->pshared = pshared;
+    ch->policy = policy;
+    ch->open_producers = producers;
+    size_t data = (sizeof(lane_channel) + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE * CACHE_LINE_SIZE;
+    for(int i = 0; i < LANES; i++){
+        ch->lanes[i].data = data;
+        data += (size_t)lane_slots[i] * lane_len[i];
+    }
+    return 0;
+}
+
+static inline char *lane_slot(lane_channel *ch, int lane, uint64_t pos){
+    return (char *)ch + ch->lanes[lane].data + (pos % lane_slots[lane]) * lane_len[lane];
+}
+
+static inline int lane_empty(lane_channel *ch, int lane){
+    lane_ring *ring = &ch->lanes[lane];
+    return __atomic_load_n(&ring->tail, __ATOMIC_RELAXED) == __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+}
+
+static void lane_ring_doorbell(lane_channel *ch){
+    // pairs with the register-then-recheck in lane_recv().
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if(__atomic_load_n(&ch->consumer_waiting, __ATOMIC_RELAXED)){
+        __atomic_fetch_add(&ch->doorbell, 1, __ATOMIC_RELEASE);
+        futex_wake(&ch->doorbell, 1, ch->pshared);
+    }
+}
+
+// Sends lane_len[lane] bytes of message; blocks while the lane is full and
+// counts that in ctr->blocks.
+static void lane_send(lane_channel *ch, int lane, const char *message, bench_counters *ctr){
+    lane_ring *ring = &ch->lanes[lane];
+    uint64_t head = ring->head;
+    if(head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) >= lane_slots[lane]){
+        ctr->blocks++;
+        for(;;){
+            __atomic_store_n(&ring->producer_waiting, 1, __ATOMIC_SEQ_CST);
+            uint32_t seq = __atomic_load_n(&ring->space_seq, __ATOMIC_ACQUIRE);
+            if(head - __atomic_load_n(&ring->tail, __ATOMIC_SEQ_CST) < lane_slots[lane]) break;
+            futex_wait(&ring->space_seq, seq, ch->pshared);
+        }
+        __atomic_store_n(&ring->producer_waiting, 0, __ATOMIC_RELAXED);
+    }
+
+    memcpy(lane_slot(ch, lane, head), message, lane_len[lane]);
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+    lane_ring_doorbell(ch);
+}
+
+// A producer is done; lane_recv() returns -1 once every producer is done
+// and every lane is drained.
+static void lane_close(lane_channel *ch){
+    __atomic_fetch_sub(&ch->open_producers, 1, __ATOMIC_SEQ_CST);
+    lane_ring_doorbell(ch);
+}
+
+// The lane to serve next under ch->policy, or -1 if all are empty.
+static int lane_pick(lane_channel *ch){
+    int ready[LANES];
+    int best = -1;
+    for(int i = 0; i < LANES; i++){
+        ready[i] = !lane_empty(ch, i);
+    }
+
+    if(ch->policy == LANE_FIFO){
+        uint64_t oldest = UINT64_MAX;
+        for(int i = 0; i < LANES; i++){
+            if(!ready[i]) continue;
+            uint64_t stamp = read_send_stamp(lane_slot(ch, i, ch->lanes[i].tail), lane_len[i]);
+            if(stamp < oldest){
+                oldest = stamp;
+                best = i;
+            }
+        }
+        return best;
+    }
+
+    // a starved lane first (the lowest one if several are due) ...
+    for(int i = LANES - 1; i > 0; i--){
+        if(ready[i] && ch->lanes[i].passed >= lane_starve[i]){
+            best = i;
+            break;
+        }
+    }
+    // ... otherwise the highest lane with messages.
+    for(int i = 0; best < 0 && i < LANES; i++){
+        if(ready[i]) best = i;
+    }
+    for(int i = 0; best >= 0 && i < LANES; i++){
+        if(i == best){
+            ch->lanes[i].passed = 0;
+        }else if(ready[i] && i > best){
+            ch->lanes[i].passed++;
+        }
+    }
+    return best;
+}
+
+// Blocks until a message is available on any lane, copies it to message
+// (at least LANE_MAX_LEN bytes) and returns its lane; -1 once every
+// producer has closed and the lanes are empty. Every sleep is counted in
+// ctr->blocks.
+static int lane_recv(lane_channel *ch, char *message, bench_counters *ctr){
+    int lane;
+    while((lane = lane_pick(ch)) < 0){
+        if(__atomic_load_n(&ch->open_producers, __ATOMIC_ACQUIRE) == 0){
+            // closed after its last send: one more look and we are done.
+            if((lane = lane_pick(ch)) < 0) return -1;
+            break;
+        }
+        ctr->blocks++;
+        __atomic_store_n(&ch->consumer_waiting, 1, __ATOMIC_SEQ_CST);
+        uint32_t seq = __atomic_load_n(&ch->doorbell, __ATOMIC_ACQUIRE);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        int idle = __atomic_load_n(&ch->open_producers, __ATOMIC_RELAXED) > 0;
+        for(int i = 0; idle && i < LANES; i++){
+            if(!lane_empty(ch, i)) idle = 0;
+        }
+        if(idle) futex_wait(&ch->doorbell, seq, ch->pshared);
+        __atomic_store_n(&ch->consumer_waiting, 0, __ATOMIC_RELAXED);
+    }
+
+    lane_ring *ring = &ch->lanes[lane];
+    uint64_t tail = ring->tail;
+    memcpy(message, lane_slot(ch, lane, tail), lane_len[lane]);
+    __atomic_store_n(&ring->tail, tail + 1, __ATOMIC_RELEASE);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if(__atomic_load_n(&ring->producer_waiting, __ATOMIC_RELAXED)){
+        __atomic_fetch_add(&ring->space_seq, 1, __ATOMIC_RELEASE);
+        futex_wake(&ring->space_seq, 1, ch->pshared);
+    }
+    return lane;
+}
+
+#endif
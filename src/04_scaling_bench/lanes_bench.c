@@ -0,0 +1,211 @@
+#define _GNU_SOURCE
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <stdio.h>     // printf
+#include <stdlib.h>    // macros
+#include <string.h>
+#include <unistd.h>    // fork, getopt
+#include <pthread.h>
+#include "lane_channel.h"
+#include "../common/latency_hist.h"
+
+// --- Priority lane benchmark ---
+// One producer per lane of a lane_channel (high, normal, bulk) and one
+// consumer, under mixed load: every producer sends for `seconds` at its own
+// rate (open loop, messages stamped with their intended send time; rate 0 =
+// as fast as the lane takes them, stamped when sent). The consumer
+// checksums every message, so a 64 KB bulk message costs what it would
+// cost a real reader, and records per-lane latency.
+//
+//   ./lanes_bench [-m thread|process] [-P priority|fifo] [-d seconds] [-r high,normal,bulk]
+//
+// Defaults: priority, 2 s, rates 1000,5000,0 (bulk saturates its lane).
+//
+// Output, one line per lane:
+//   policy,lane,message_len,messages,msgs_per_s,blocks_per_msg,
+//   latency_mean,latency_p50,latency_p90,latency_p99,latency_p99.9,latency_max (ns)
+
+typedef struct {
+    pthread_barrier_t start_barrier;
+    uint64_t duration_ns;
+    double rates[LANES];
+    volatile uint64_t checksum;
+    bench_counters counters[LANES + 1];     // producers by lane, then the consumer
+    uint64_t received[LANES];
+    latency_hist latency[LANES];
+} lanes_header;
+
+typedef struct {
+    lanes_header *header;
+    lane_channel *channel;
+    int id;                                 // lane of a producer, LANES for the consumer
+} lanes_worker;
+
+
+static void run_producer(lanes_header *header, lane_channel *ch, int lane){
+    bench_counters *ctr = &header->counters[lane];
+    char *message = malloc(lane_len[lane]);
+    memset(message, 'A' + lane, lane_len[lane]);
+    double rate = header->rates[lane];
+
+    pthread_barrier_wait(&header->start_barrier);
+    open_loop_pacer pacer;
+    pacer_start(&pacer, monotonic_ns());
+    if(rate > 0) pacer_set_rate(&pacer, rate);
+    uint64_t end_ns = pacer.next_ns + header->duration_ns;
+
+    for(;;){
+        uint64_t stamp = rate > 0 ? pacer_wait(&pacer) : monotonic_ns();
+        if(stamp >= end_ns) break;
+        write_send_stamp(message, lane_len[lane], stamp);
+        lane_send(ch, lane, message, ctr);
+        ctr->messages++;
+    }
+    lane_close(ch);
+    free(message);
+}
+
+static void run_consumer(lanes_header *header, lane_channel *ch){
+    bench_counters *ctr = &header->counters[LANES];
+    char *message = malloc(LANE_MAX_LEN);
+
+    pthread_barrier_wait(&header->start_barrier);
+    int lane;
+    while((lane = lane_recv(ch, message, ctr)) >= 0){
+        uint64_t total_checksum = 0;
+        for(uint32_t j = 0; j < lane_len[lane]; j++){
+            total_checksum += message[j];
+        }
+        header->checksum = total_checksum;
+        hist_record(&header->latency[lane], monotonic_ns() - read_send_stamp(message, lane_len[lane]));
+        header->received[lane]++;
+        ctr->messages++;
+    }
+    free(message);
+}
+
+static void *worker(void *arg){
+    lanes_worker *w = arg;
+    if(w->id < LANES){
+        run_producer(w->header, w->channel, w->id);
+    }else{
+        run_consumer(w->header, w->channel);
+    }
+    return NULL;
+}
+
+
+int main(int argc, char *argv[])
+{
+    const char *model = "thread";
+    const char *policy_name = "priority";
+    double seconds = 2;
+    double rates[LANES] = { 1000, 5000, 0 };
+
+    int opt;
+    while((opt = getopt(argc, argv, "m:P:d:r:")) != -1){
+        switch(opt){
+            case 'm': model = optarg; break;
+            case 'P': policy_name = optarg; break;
+            case 'd': seconds = atof(optarg); break;
+            case 'r':
+                if(sscanf(optarg, "%lf,%lf,%lf", &rates[0], &rates[1], &rates[2]) != LANES){
+                    fprintf(stderr, "-r wants high,normal,bulk rates\n");
+                    return EXIT_FAILURE;
+                }
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-m thread|process] [-P priority|fifo] [-d seconds] [-r high,normal,bulk]\n", argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    int process_model = strcmp(model, "process") == 0;
+    if(!process_model && strcmp(model, "thread") != 0){
+        fprintf(stderr, "unknown model \"%s\" (thread, process)\n", model);
+        return EXIT_FAILURE;
+    }
+    int policy = strcmp(policy_name, "fifo") == 0 ? LANE_FIFO : LANE_PRIORITY;
+    if(policy == LANE_PRIORITY && strcmp(policy_name, "priority") != 0){
+        fprintf(stderr, "unknown policy \"%s\" (priority, fifo)\n", policy_name);
+        return EXIT_FAILURE;
+    }
+    if(LANE_HIGH_LEN < SEND_STAMP_LEN){
+        fprintf(stderr, "LANE_HIGH_LEN must hold a %zu-byte send stamp\n", SEND_STAMP_LEN);
+        return EXIT_FAILURE;
+    }
+
+    size_t header_size = (sizeof(lanes_header) + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE * CACHE_LINE_SIZE;
+    size_t segment_size = header_size + lane_channel_size();
+    void *buffer = mmap(NULL, segment_size, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_ANONYMOUS, -1, 0);
+    if(buffer == MAP_FAILED){
+        perror("mmap() failed.");
+        return EXIT_FAILURE;
+    }
+    lanes_header *header = buffer;
+    lane_channel *ch = (lane_channel *)((char *)buffer + header_size);
+    header->duration_ns = (uint64_t)(seconds * 1e9);
+    for(int i = 0; i < LANES; i++){
+        header->rates[i] = rates[i];
+        hist_reset(&header->latency[i]);
+    }
+    lane_channel_init(ch, process_model, policy, LANES);
+
+    pthread_barrierattr_t attr;
+    pthread_barrierattr_init(&attr);
+    if(process_model) pthread_barrierattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+    if(pthread_barrier_init(&header->start_barrier, &attr, LANES + 1) != 0){
+        perror("pthread_barrier_init() failed.");
+        return EXIT_FAILURE;
+    }
+    pthread_barrierattr_destroy(&attr);
+
+    pthread_t threads[LANES + 1];
+    pid_t pids[LANES + 1];
+    lanes_worker workers[LANES + 1];
+    for(int i = 0; i <= LANES; i++){
+        workers[i].header = header;
+        workers[i].channel = ch;
+        workers[i].id = i;
+        if(process_model){
+            fflush(NULL);
+            pids[i] = fork();
+            if(pids[i] == -1){
+                perror("fork() failed.");
+                return EXIT_FAILURE;
+            }
+            if(pids[i] == 0){
+                worker(&workers[i]);
+                _exit(EXIT_SUCCESS);
+            }
+        }else if(pthread_create(&threads[i], NULL, worker, &workers[i]) != 0){
+            perror("pthread_create() failed.");
+            return EXIT_FAILURE;
+        }
+    }
+    for(int i = 0; i <= LANES; i++){
+        if(process_model){
+            waitpid(pids[i], NULL, 0);
+        }else{
+            pthread_join(threads[i], NULL);
+        }
+    }
+
+    int ok = 1;
+    for(int i = 0; i < LANES; i++){
+        uint64_t sent = header->counters[i].messages;
+        if(header->received[i] != sent){
+            fprintf(stderr, "lane %s lost messages: sent %llu, received %llu\n", lane_names[i],
+                    (unsigned long long)sent, (unsigned long long)header->received[i]);
+            ok = 0;
+        }
+        printf("%s,%s,%u,%llu,%.0f,%.4f", policy == LANE_FIFO ? "fifo" : "priority", lane_names[i],
+               lane_len[i], (unsigned long long)sent, sent / seconds,
+               sent ? (double)header->counters[i].blocks / sent : 0.0);
+        hist_print_csv(&header->latency[i]);
+        printf("\n");
+    }
+
+    pthread_barrier_destroy(&header->start_barrier);
+    munmap(buffer, segment_size);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,214 @@
+#define _GNU_SOURCE // sched_setaffinity, CPU_SET
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <stdio.h>     // printf
+#include <stdlib.h>    // macros
+#include <string.h>
+#include <unistd.h>    // fork, getopt
+#include <pthread.h>
+#include "backends.h"
+#include "../common/latency_hist.h"
+#include "../common/open_loop.h"   // monotonic_ns, send stamps
+
+// --- Ping-pong RPC benchmark ---
+// A client and a server connected by a pair of rings from one backend: the
+// client sends requests on the request ring, the server echoes each one
+// back on the reply ring. The client keeps up to `outstanding` requests in
+// flight (1 = strict ping-pong) and records every round trip, from putting
+// the request to getting its reply, in a latency histogram.
+//
+//   ./rpc_bench [-m thread|process] [-b backend] [-n rpcs] [-o outstanding] [-a]
+//
+//   -a  pin the client to CPU 0 and the server to CPU 1
+//
+// Output: model,backend,outstanding,rpcs,elapsed_s,rpcs_per_s,blocks_per_rpc,
+//         rtt_mean,rtt_p50,rtt_p90,rtt_p99,rtt_p99.9,rtt_max (ns)
+
+typedef struct {
+    pthread_barrier_t start_barrier;
+    uint64_t rpcs;
+    int outstanding;
+    bench_counters counters[2];         // client, server
+    latency_hist rtt;
+} rpc_header;
+
+typedef struct {
+    const bench_backend *backend;
+    rpc_header *header;
+    void *request_ring;
+    void *reply_ring;
+    int pin;
+} rpc_config;
+
+
+static void run_client(rpc_config *config){
+    char message[MAX_MESSAGE_LEN];
+    memset(message, 'A', MAX_MESSAGE_LEN);
+    bench_counters *ctr = &config->header->counters[0];
+    uint64_t rpcs = config->header->rpcs;
+    uint64_t sent = 0;
+
+    for(uint64_t done = 0; done < rpcs; done++){
+        while(sent < rpcs && sent - done < (uint64_t)config->header->outstanding){
+            write_send_stamp(message, MAX_MESSAGE_LEN, monotonic_ns());
+            config->backend->put(config->request_ring, 0, message, ctr);
+            sent++;
+        }
+        config->backend->get(config->reply_ring, 0, message, ctr);
+        hist_record(&config->header->rtt, monotonic_ns() - read_send_stamp(message, MAX_MESSAGE_LEN));
+        ctr->messages++;
+    }
+}
+
+static void run_server(rpc_config *config){
+    char message[MAX_MESSAGE_LEN];
+    bench_counters *ctr = &config->header->counters[1];
+
+    for(uint64_t i = 0; i < config->header->rpcs; i++){
+        config->backend->get(config->request_ring, 0, message, ctr);
+        message[0] ^= 1;                // "handle" the request
+        config->backend->put(config->reply_ring, 0, message, ctr);
+        ctr->messages++;
+    }
+}
+
+static void *side(rpc_config *config, int server){
+    if(config->pin) pin_worker(server);
+    pthread_barrier_wait(&config->header->start_barrier);
+    if(server){
+        run_server(config);
+    }else{
+        run_client(config);
+    }
+    return NULL;
+}
+
+static void *client_thread(void *arg){
+    return side(arg, 0);
+}
+
+static void *server_thread(void *arg){
+    return side(arg, 1);
+}
+
+
+int main(int argc, char *argv[])
+{
+    const char *model = "thread";
+    const char *backend_name = "sem";
+    rpc_config config = { 0 };
+    uint64_t rpcs = 100000;
+    int outstanding = 1;
+
+    int opt;
+    while((opt = getopt(argc, argv, "m:b:n:o:a")) != -1){
+        switch(opt){
+            case 'm': model = optarg; break;
+            case 'b': backend_name = optarg; break;
+            case 'n': rpcs = strtoull(optarg, NULL, 10); break;
+            case 'o': outstanding = atoi(optarg); break;
+            case 'a': config.pin = 1; break;
+            default:
+                fprintf(stderr, "usage: %s [-m thread|process] [-b backend] [-n rpcs] [-o outstanding] [-a]\n", argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    int process_model = strcmp(model, "process") == 0;
+    if(!process_model && strcmp(model, "thread") != 0){
+        fprintf(stderr, "unknown model \"%s\" (thread, process)\n", model);
+        return EXIT_FAILURE;
+    }
+    config.backend = backend_by_name(backend_name);
+    if(config.backend == NULL){
+        fprintf(stderr, "unknown backend \"%s\"\n", backend_name);
+        return EXIT_FAILURE;
+    }
+    // each ring holds at most `outstanding` messages, so a full ring can
+    // never block both sides at once.
+    if(outstanding < 1 || outstanding > BUFFER_SIZE){
+        fprintf(stderr, "outstanding must be 1..BUFFER_SIZE (%d)\n", BUFFER_SIZE);
+        return EXIT_FAILURE;
+    }
+    if(MAX_MESSAGE_LEN < SEND_STAMP_LEN){
+        fprintf(stderr, "MAX_MESSAGE_LEN must hold a %zu-byte send stamp\n", SEND_STAMP_LEN);
+        return EXIT_FAILURE;
+    }
+
+    size_t header_size = (sizeof(rpc_header) + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE * CACHE_LINE_SIZE;
+    size_t ring_size = (config.backend->state_size(1, 1) + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE * CACHE_LINE_SIZE;
+    size_t segment_size = header_size + 2 * ring_size;
+    void *buffer = mmap(NULL, segment_size, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_ANONYMOUS, -1, 0);
+    if(buffer == MAP_FAILED){
+        perror("mmap() failed.");
+        return EXIT_FAILURE;
+    }
+    config.header = buffer;
+    config.request_ring = (char *)buffer + header_size;
+    config.reply_ring = (char *)buffer + header_size + ring_size;
+    config.header->rpcs = rpcs;
+    config.header->outstanding = outstanding;
+    hist_reset(&config.header->rtt);
+
+    pthread_barrierattr_t attr;
+    pthread_barrierattr_init(&attr);
+    if(process_model) pthread_barrierattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+    if(pthread_barrier_init(&config.header->start_barrier, &attr, 3) != 0){
+        perror("pthread_barrier_init() failed.");
+        return EXIT_FAILURE;
+    }
+    pthread_barrierattr_destroy(&attr);
+    if(config.backend->init(config.request_ring, process_model, 1, 1) == -1 ||
+       config.backend->init(config.reply_ring, process_model, 1, 1) == -1){
+        return EXIT_FAILURE;
+    }
+
+    pthread_t threads[2];
+    pid_t pids[2];
+    void *(*sides[2])(void *) = { client_thread, server_thread };
+    for(int i = 0; i < 2; i++){
+        if(process_model){
+            fflush(NULL);
+            pids[i] = fork();
+            if(pids[i] == -1){
+                perror("fork() failed.");
+                return EXIT_FAILURE;
+            }
+            if(pids[i] == 0){
+                sides[i](&config);
+                _exit(EXIT_SUCCESS);
+            }
+        }else if(pthread_create(&threads[i], NULL, sides[i], &config) != 0){
+            perror("pthread_create() failed.");
+            return EXIT_FAILURE;
+        }
+    }
+
+    pthread_barrier_wait(&config.header->start_barrier);
+    uint64_t start_ns = monotonic_ns();
+    for(int i = 0; i < 2; i++){
+        if(process_model){
+            waitpid(pids[i], NULL, 0);
+        }else{
+            pthread_join(threads[i], NULL);
+        }
+    }
+    double elapsed = (monotonic_ns() - start_ns) / 1e9;
+
+    uint64_t replies = config.header->counters[0].messages;
+    if(replies != rpcs){
+        fprintf(stderr, "lost replies: sent %llu, received %llu\n",
+                (unsigned long long)rpcs, (unsigned long long)replies);
+    }
+    uint64_t blocks = config.header->counters[0].blocks + config.header->counters[1].blocks;
+
+    printf("%s,%s,%d,%llu,%.9f,%.0f,%.4f", model, config.backend->name, outstanding,
+           (unsigned long long)rpcs, elapsed, rpcs / elapsed, (double)blocks / rpcs);
+    hist_print_csv(&config.header->rtt);
+    printf("\n");
+
+    config.backend->destroy(config.request_ring);
+    config.backend->destroy(config.reply_ring);
+    pthread_barrier_destroy(&config.header->start_barrier);
+    munmap(buffer, segment_size);
+    return replies == rpcs ? EXIT_SUCCESS : EXIT_FAILURE;
+}
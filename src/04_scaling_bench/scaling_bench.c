@@ -0,0 +1,262 @@
+#define _GNU_SOURCE // sched_setaffinity, CPU_SET
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <stdio.h>     // printf
+#include <stdlib.h>    // macros
+#include <string.h>
+#include <unistd.h>    // fork, getopt
+#include <sched.h>
+#include <pthread.h>
+#include <time.h>
+#include "backends.h"
+
+// --- Scaling benchmark ---
+// P producers push `messages` messages in total through one backend to C
+// consumers, as threads of one process or as forked processes sharing an
+// anonymous MAP_SHARED segment, and one CSV line describes the run:
+//
+//   ./scaling_bench [-m thread|process] [-b backend] [-p P] [-c C] [-n messages] [-a] [-v]
+//
+//   -a  pin worker i to CPU i % online CPUs (producers first)
+//   -v  also print one "producer,<id>,<messages>,<seconds>,<msgs_per_s>" line
+//       per producer
+//
+// Output: model,backend,producers,consumers,messages,elapsed_s,msgs_per_s,
+//         msgs_per_s_per_worker,blocks_per_msg,vcsw_per_msg,ivcsw_per_msg,cpu_s,
+//         producer_fairness
+// blocks_per_msg counts every time a worker had to wait for its turn (a
+// failed trylock/trywait or a cond_wait); the context switch counts and
+// cpu_s come from getrusage(). producer_fairness is Jain's index over the
+// producers' own throughput (1.0 = every producer got its share through at
+// the same rate, 1/P = one producer hogged the channel).
+
+typedef struct {
+    pthread_barrier_t start_barrier;
+    uint64_t messages;                  // total to send
+    uint64_t claimed CACHE_ALIGNED;     // consumer tickets handed out
+    volatile uint64_t checksum CACHE_ALIGNED;
+    bench_counters counters[MAX_WORKERS];
+} bench_header;
+
+typedef struct {
+    const bench_backend *backend;
+    bench_header *header;
+    void *state;
+    int producers, consumers;
+    int pin;
+} bench_config;
+
+typedef struct {
+    bench_config *config;
+    int id;                             // 0..P-1 producers, P..P+C-1 consumers
+} worker_arg;
+
+
+static double get_elapsed_seconds(struct timespec start, struct timespec end) {
+    return (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+}
+
+static uint64_t now_ns(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static double worker_rate(const bench_counters *ctr){
+    double seconds = (ctr->end_ns - ctr->start_ns) / 1e9;
+    return seconds > 0 ? ctr->messages / seconds : 0;
+}
+
+static void run_producer(bench_config *config, int producer, bench_counters *ctr){
+    char message[MAX_MESSAGE_LEN];
+    memset(message, 'A', MAX_MESSAGE_LEN);
+    uint64_t total = config->header->messages;
+    // spread the remainder over the first producers.
+    uint64_t share = total / config->producers + ((uint64_t)producer < total % config->producers);
+
+    for(uint64_t i = 0; i < share; i++){
+        config->backend->put(config->state, producer, message, ctr);
+        ctr->messages++;
+    }
+}
+
+static void run_consumer(bench_config *config, int consumer, bench_counters *ctr){
+    char message[MAX_MESSAGE_LEN];
+    uint64_t total = config->header->messages;
+    uint64_t checksum = 0;
+
+    while(__atomic_fetch_add(&config->header->claimed, 1, __ATOMIC_RELAXED) < total){
+        config->backend->get(config->state, consumer, message, ctr);
+        for(int j = 0; j < MAX_MESSAGE_LEN; j++){
+            checksum += message[j];
+        }
+        ctr->messages++;
+    }
+    config->header->checksum = checksum;
+}
+
+static void *worker(void *arg){
+    worker_arg *w = arg;
+    bench_config *config = w->config;
+    bench_counters *ctr = &config->header->counters[w->id];
+    if(config->pin) pin_worker(w->id);
+
+    pthread_barrier_wait(&config->header->start_barrier);
+    ctr->start_ns = now_ns();
+    if(w->id < config->producers){
+        run_producer(config, w->id, ctr);
+    }else{
+        run_consumer(config, w->id - config->producers, ctr);
+    }
+    ctr->end_ns = now_ns();
+    return NULL;
+}
+
+
+int main(int argc, char *argv[])
+{
+    const char *model = "thread";
+    const char *backend_name = "sem";
+    bench_config config = { .producers = 1, .consumers = 1 };
+    uint64_t messages = 1000000;
+    int verbose = 0;
+
+    int opt;
+    while((opt = getopt(argc, argv, "m:b:p:c:n:av")) != -1){
+        switch(opt){
+            case 'm': model = optarg; break;
+            case 'b': backend_name = optarg; break;
+            case 'p': config.producers = atoi(optarg); break;
+            case 'c': config.consumers = atoi(optarg); break;
+            case 'n': messages = strtoull(optarg, NULL, 10); break;
+            case 'a': config.pin = 1; break;
+            case 'v': verbose = 1; break;
+            default:
+                fprintf(stderr, "usage: %s [-m thread|process] [-b backend] [-p producers] [-c consumers] [-n messages] [-a] [-v]\n", argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    int process_model = strcmp(model, "process") == 0;
+    if(!process_model && strcmp(model, "thread") != 0){
+        fprintf(stderr, "unknown model \"%s\" (thread, process)\n", model);
+        return EXIT_FAILURE;
+    }
+    config.backend = backend_by_name(backend_name);
+    if(config.backend == NULL){
+        fprintf(stderr, "unknown backend \"%s\"\n", backend_name);
+        return EXIT_FAILURE;
+    }
+    int workers = config.producers + config.consumers;
+    if(config.producers < 1 || config.consumers < 1 || workers > MAX_WORKERS){
+        fprintf(stderr, "need 1..%d workers with at least one producer and one consumer\n", MAX_WORKERS);
+        return EXIT_FAILURE;
+    }
+
+    // header and backend state in one shared anonymous mapping, so forked
+    // workers see the same memory as threads do.
+    size_t header_size = (sizeof(bench_header) + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE * CACHE_LINE_SIZE;
+    size_t segment_size = header_size + config.backend->state_size(config.producers, config.consumers);
+    void *buffer = mmap(NULL, segment_size, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_ANONYMOUS, -1, 0);
+    if(buffer == MAP_FAILED){
+        perror("mmap() failed.");
+        return EXIT_FAILURE;
+    }
+    config.header = buffer;
+    config.state = (char *)buffer + header_size;
+    config.header->messages = messages;
+
+    pthread_barrierattr_t attr;
+    pthread_barrierattr_init(&attr);
+    if(process_model) pthread_barrierattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+    if(pthread_barrier_init(&config.header->start_barrier, &attr, workers + 1) != 0){
+        perror("pthread_barrier_init() failed.");
+        return EXIT_FAILURE;
+    }
+    pthread_barrierattr_destroy(&attr);
+    if(config.backend->init(config.state, process_model, config.producers, config.consumers) == -1){
+        return EXIT_FAILURE;
+    }
+
+    struct rusage usage_before, usage_after;
+    getrusage(process_model ? RUSAGE_CHILDREN : RUSAGE_SELF, &usage_before);
+
+    worker_arg args[MAX_WORKERS];
+    pthread_t threads[MAX_WORKERS];
+    pid_t pids[MAX_WORKERS];
+    for(int i = 0; i < workers; i++){
+        args[i].config = &config;
+        args[i].id = i;
+        if(process_model){
+            fflush(NULL);
+            pids[i] = fork();
+            if(pids[i] == -1){
+                perror("fork() failed.");
+                return EXIT_FAILURE;
+            }
+            if(pids[i] == 0){
+                worker(&args[i]);
+                _exit(EXIT_SUCCESS);
+            }
+        }else if(pthread_create(&threads[i], NULL, worker, &args[i]) != 0){
+            perror("pthread_create() failed.");
+            return EXIT_FAILURE;
+        }
+    }
+
+    struct timespec start_time, end_time;
+    pthread_barrier_wait(&config.header->start_barrier);
+    clock_gettime(CLOCK_MONOTONIC, &start_time);
+
+    for(int i = 0; i < workers; i++){
+        if(process_model){
+            waitpid(pids[i], NULL, 0);
+        }else{
+            pthread_join(threads[i], NULL);
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end_time);
+    getrusage(process_model ? RUSAGE_CHILDREN : RUSAGE_SELF, &usage_after);
+
+    uint64_t blocks = 0, received = 0;
+    double rate_sum = 0, rate_sq_sum = 0;
+    for(int i = 0; i < workers; i++){
+        blocks += config.header->counters[i].blocks;
+        if(i >= config.producers){
+            received += config.header->counters[i].messages;
+        }else{
+            double r = worker_rate(&config.header->counters[i]);
+            rate_sum += r;
+            rate_sq_sum += r * r;
+        }
+    }
+    double fairness = rate_sq_sum > 0 ? rate_sum * rate_sum / (config.producers * rate_sq_sum) : 1.0;
+    if(received != messages){
+        fprintf(stderr, "lost messages: sent %llu, received %llu\n",
+                (unsigned long long)messages, (unsigned long long)received);
+    }
+
+    double elapsed = get_elapsed_seconds(start_time, end_time);
+    double rate = messages / elapsed;
+    double vcsw = usage_after.ru_nvcsw - usage_before.ru_nvcsw;
+    double ivcsw = usage_after.ru_nivcsw - usage_before.ru_nivcsw;
+    double cpu = (usage_after.ru_utime.tv_sec - usage_before.ru_utime.tv_sec)
+               + (usage_after.ru_utime.tv_usec - usage_before.ru_utime.tv_usec) / 1e6
+               + (usage_after.ru_stime.tv_sec - usage_before.ru_stime.tv_sec)
+               + (usage_after.ru_stime.tv_usec - usage_before.ru_stime.tv_usec) / 1e6;
+
+    printf("%s,%s,%d,%d,%llu,%.9f,%.0f,%.0f,%.4f,%.4f,%.4f,%.3f,%.4f\n",
+           model, config.backend->name, config.producers, config.consumers,
+           (unsigned long long)messages, elapsed, rate, rate / workers,
+           (double)blocks / messages, vcsw / messages, ivcsw / messages, cpu, fairness);
+    for(int i = 0; verbose && i < config.producers; i++){
+        bench_counters *ctr = &config.header->counters[i];
+        printf("producer,%d,%llu,%.9f,%.0f\n", i, (unsigned long long)ctr->messages,
+               (ctr->end_ns - ctr->start_ns) / 1e9, worker_rate(ctr));
+    }
+
+    config.backend->destroy(config.state);
+    pthread_barrier_destroy(&config.header->start_barrier);
+    munmap(buffer, segment_size);
+    return received == messages ? EXIT_SUCCESS : EXIT_FAILURE;
+}
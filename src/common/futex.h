@@ -0,0 +1,49 @@
+#ifndef FUTEX_H
+#define FUTEX_H
+
+// --- Futex wrappers ---
+// Thin syscall(2) wrappers (glibc has none). `pshared` selects the shared
+// futex ops for words that live in memory mapped by several processes; the
+// private ops are cheaper when every waiter is a thread of one process.
+// syscall() needs _GNU_SOURCE (or the default feature set) in the includer.
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <errno.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+
+// Sleeps while *word == expected. Spurious returns (EINTR, EAGAIN) are
+// expected; callers always recheck their condition.
+static inline void futex_wait(uint32_t *word, uint32_t expected, int pshared){
+    syscall(SYS_futex, word, pshared ? FUTEX_WAIT : FUTEX_WAIT_PRIVATE, expected, NULL, NULL, 0);
+}
+
+static inline void futex_wake(uint32_t *word, int count, int pshared){
+    syscall(SYS_futex, word, pshared ? FUTEX_WAKE : FUTEX_WAKE_PRIVATE, count, NULL, NULL, 0);
+}
+
+// futex_waitv(2) (Linux 5.16+): sleeps until any of up to FUTEX_WAITV_MAX
+// words differs from its expected value or is woken with futex_wake().
+// Returns the index of the woken word, or -1 with errno set; EAGAIN and
+// EINTR are spurious returns like above, ENOSYS means the kernel (or the
+// headers we were built against) lack it.
+#if defined(SYS_futex_waitv) && defined(FUTEX_WAITV_MAX)
+    #define FUTEX_HAVE_WAITV 1
+
+static inline void futex_waitv_set(struct futex_waitv *waiter, uint32_t *word, uint32_t expected, int pshared){
+    waiter->val = expected;
+    waiter->uaddr = (uintptr_t)word;
+    waiter->flags = FUTEX_32 | (pshared ? 0 : FUTEX_PRIVATE_FLAG);
+    waiter->__reserved = 0;
+}
+
+static inline long futex_waitv(struct futex_waitv *waiters, unsigned count){
+    return syscall(SYS_futex_waitv, waiters, count, 0, NULL, CLOCK_MONOTONIC);
+}
+#else
+    #define FUTEX_HAVE_WAITV 0
+#endif
+
+#endif
@@ -0,0 +1,358 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+// --- Segmented journal ---
+// An append-only message log in mmap'ed regular files
+// "<path>.0", "<path>.1", ... of JOURNAL_SEGMENT_BYTES each. A segment is
+//
+//   [journal_segment_header][index: offset of record i][records ...]
+//
+// and a record is a journal_record_header followed by the payload, 64-byte
+// aligned. The writer fills a record in place (journal_reserve), then
+// publishes it by storing its offset in the index and bumping the header's
+// `count` with release order (journal_commit). Any process that maps the
+// same file sees committed records at memory speed, through the page
+// cache, while the writer keeps appending. When a segment runs out of data
+// or index space it is sealed and the log continues in the next file.
+//
+// Durability is a build-time policy, applied every JOURNAL_SYNC_INTERVAL
+// records and when a segment is sealed or the journal closed:
+//   JOURNAL_SYNC_NONE       leave it to the kernel's writeback
+//   JOURNAL_SYNC_MSYNC      msync(MS_SYNC) of the pages written since the last sync
+//   JOURNAL_SYNC_FDATASYNC  fdatasync() of the segment file
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define JOURNAL_SYNC_NONE      0
+#define JOURNAL_SYNC_MSYNC     1
+#define JOURNAL_SYNC_FDATASYNC 2
+
+#ifndef JOURNAL_SYNC_POLICY
+    #define JOURNAL_SYNC_POLICY JOURNAL_SYNC_NONE
+#endif
+#ifndef JOURNAL_SYNC_INTERVAL
+    #define JOURNAL_SYNC_INTERVAL 1024          // records between syncs
+#endif
+#ifndef JOURNAL_SEGMENT_BYTES
+    #define JOURNAL_SEGMENT_BYTES (64ULL << 20)
+#endif
+#ifndef JOURNAL_INDEX_ENTRIES
+    #define JOURNAL_INDEX_ENTRIES 65536         // records per segment, at most
+#endif
+#define JOURNAL_MAX_SEGMENTS 4096
+#define JOURNAL_RECORD_ALIGN 64
+#define JOURNAL_MAGIC 0x314C4E524A435050ULL     // "PPCJRNL1"
+
+typedef struct{
+    uint64_t magic;
+    uint32_t segment;                           // file number
+    uint32_t sealed;                            // full, continue in segment + 1
+    uint64_t first_seq;                         // sequence number of record 0
+    uint64_t index_entries;
+    uint64_t data_start;                        // offset of the first record
+    uint64_t count;                             // committed records (release/acquire)
+    uint32_t closed;                            // the writer is done: the log ends here
+    uint32_t reserved;
+} journal_segment_header;
+
+typedef struct{
+    uint64_t seq;
+    uint32_t length;
+    uint32_t reserved;
+} journal_record_header;
+
+// Where a record lives; this is what goes through the ring in place of
+// the payload.
+typedef struct{
+    uint32_t segment;
+    uint32_t length;
+    uint64_t offset;                            // of the record header
+} journal_ref;
+
+#define JOURNAL_INDEX_OFFSET \
+    ((sizeof(journal_segment_header) + JOURNAL_RECORD_ALIGN - 1) / JOURNAL_RECORD_ALIGN * JOURNAL_RECORD_ALIGN)
+#define JOURNAL_DATA_START \
+    ((JOURNAL_INDEX_OFFSET + JOURNAL_INDEX_ENTRIES * sizeof(uint64_t) + 4095) / 4096 * 4096)
+
+// "<path>.<segment>". Name buffers are sized sizeof(path) + 12 (dot, up
+// to ten digits, NUL), so only a caller-supplied path can overflow them.
+static inline int journal_segment_path(char *out, size_t size, const char *path, uint32_t segment){
+    int len = snprintf(out, size, "%s.%u", path, segment);
+    if(len < 0 || (size_t)len >= size){
+        fprintf(stderr, "journal path \"%s\" is too long.\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+// Copy the base path, or fail if it does not fit.
+static inline int journal_set_path(char *out, size_t size, const char *path){
+    int len = snprintf(out, size, "%s", path);
+    if(len < 0 || (size_t)len >= size){
+        fprintf(stderr, "journal path \"%s\" is too long (max %zu bytes).\n", path, size - 1);
+        out[0] = '\0';
+        return -1;
+    }
+    return 0;
+}
+
+static inline uint64_t *journal_index(char *base){
+    return (uint64_t *)(base + JOURNAL_INDEX_OFFSET);
+}
+
+
+// --- Writer ---
+typedef struct{
+    char path[256];
+    int fd;
+    uint32_t segment;
+    char *base;                                 // mapping of the current segment
+    uint64_t next_seq;
+    uint64_t data_end;                          // first free byte
+    uint64_t pending;                           // offset of the reserved record
+    uint64_t synced_end;                        // data synced up to here
+    uint64_t synced_count;                      // index entries synced
+    uint64_t unsynced;                          // records since the last sync
+} journal_writer;
+
+static inline int journal_sync(journal_writer *w){
+#if JOURNAL_SYNC_POLICY == JOURNAL_SYNC_MSYNC
+    journal_segment_header *hdr = (journal_segment_header *)w->base;
+    uint64_t page = (uint64_t)sysconf(_SC_PAGESIZE);
+    uint64_t index_from = (JOURNAL_INDEX_OFFSET + w->synced_count * sizeof(uint64_t)) / page * page;
+    uint64_t index_to = JOURNAL_INDEX_OFFSET + hdr->count * sizeof(uint64_t);
+    uint64_t data_from = w->synced_end / page * page;
+    // header and index first page, then the new index entries, then the data.
+    if(msync(w->base, page, MS_SYNC) == -1 ||
+       (index_to > index_from && msync(w->base + index_from, index_to - index_from, MS_SYNC) == -1) ||
+       (w->data_end > data_from && msync(w->base + data_from, w->data_end - data_from, MS_SYNC) == -1)){
+        perror("msync(journal) failed.");
+        return -1;
+    }
+    w->synced_count = hdr->count;
+#elif JOURNAL_SYNC_POLICY == JOURNAL_SYNC_FDATASYNC
+    if(fdatasync(w->fd) == -1){
+        perror("fdatasync(journal) failed.");
+        return -1;
+    }
+#endif
+    w->synced_end = w->data_end;
+    w->unsynced = 0;
+    return 0;
+}
+
+static inline int journal_open_segment(journal_writer *w, uint32_t segment){
+    char name[sizeof(w->path) + 12];
+    if(journal_segment_path(name, sizeof(name), w->path, segment) == -1){
+        return -1;
+    }
+    int fd = open(name, O_RDWR|O_CREAT|O_TRUNC, 0600);
+    if(fd == -1){
+        perror("open(journal segment) failed.");
+        return -1;
+    }
+    if(ftruncate(fd, JOURNAL_SEGMENT_BYTES) == -1){
+        perror("ftruncate(journal segment) failed.");
+        close(fd);
+        return -1;
+    }
+    void *base = mmap(NULL, JOURNAL_SEGMENT_BYTES, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+    if(base == MAP_FAILED){
+        perror("mmap(journal segment) failed.");
+        close(fd);
+        return -1;
+    }
+    journal_segment_header *hdr = base;
+    hdr->segment = segment;
+    hdr->first_seq = w->next_seq;
+    hdr->index_entries = JOURNAL_INDEX_ENTRIES;
+    hdr->data_start = JOURNAL_DATA_START;
+    // magic last: a reader treats a segment without it as not there yet.
+    __atomic_store_n(&hdr->magic, JOURNAL_MAGIC, __ATOMIC_RELEASE);
+
+    w->fd = fd;
+    w->segment = segment;
+    w->base = base;
+    w->data_end = JOURNAL_DATA_START;
+    w->synced_end = JOURNAL_DATA_START;
+    w->synced_count = 0;
+    return 0;
+}
+
+// Seal (or, at the end, close) the current segment and drop its mapping.
+static inline int journal_finish_segment(journal_writer *w, int closing){
+    journal_segment_header *hdr = (journal_segment_header *)w->base;
+    int r = JOURNAL_SYNC_POLICY != JOURNAL_SYNC_NONE ? journal_sync(w) : 0;
+    __atomic_store_n(closing ? &hdr->closed : &hdr->sealed, 1, __ATOMIC_RELEASE);
+    munmap(w->base, JOURNAL_SEGMENT_BYTES);
+    close(w->fd);
+    w->base = NULL;
+    return r;
+}
+
+// Start a new journal at `path`, removing whatever an earlier run left.
+static inline int journal_create(journal_writer *w, const char *path){
+    memset(w, 0, sizeof(*w));
+    if(journal_set_path(w->path, sizeof(w->path), path) == -1){
+        return -1;
+    }
+    for(uint32_t segment = 0; segment < JOURNAL_MAX_SEGMENTS; segment++){
+        char name[sizeof(w->path) + 12];
+        if(journal_segment_path(name, sizeof(name), w->path, segment) == -1 || unlink(name) == -1) break;
+    }
+    return journal_open_segment(w, 0);
+}
+
+// Room for a `length`-byte record at the end of the log; the payload is
+// written in place and published with journal_commit(). NULL on error.
+static inline char *journal_reserve(journal_writer *w, uint32_t length, journal_ref *ref){
+    uint64_t size = (sizeof(journal_record_header) + length + JOURNAL_RECORD_ALIGN - 1)
+                  / JOURNAL_RECORD_ALIGN * JOURNAL_RECORD_ALIGN;
+    journal_segment_header *hdr = (journal_segment_header *)w->base;
+    if(hdr->count >= JOURNAL_INDEX_ENTRIES || w->data_end + size > JOURNAL_SEGMENT_BYTES){
+        if(w->data_end == JOURNAL_DATA_START || w->segment + 1 >= JOURNAL_MAX_SEGMENTS){
+            fprintf(stderr, "journal_reserve(): record does not fit or out of segments.\n");
+            return NULL;
+        }
+        if(journal_finish_segment(w, 0) == -1 || journal_open_segment(w, w->segment + 1) == -1){
+            return NULL;
+        }
+    }
+    journal_record_header *rec = (journal_record_header *)(w->base + w->data_end);
+    rec->seq = w->next_seq;
+    rec->length = length;
+    ref->segment = w->segment;
+    ref->length = length;
+    ref->offset = w->data_end;
+    w->pending = w->data_end;
+    w->data_end += size;
+    return (char *)(rec + 1);
+}
+
+static inline int journal_commit(journal_writer *w){
+    journal_segment_header *hdr = (journal_segment_header *)w->base;
+    journal_index(w->base)[hdr->count] = w->pending;
+    __atomic_store_n(&hdr->count, hdr->count + 1, __ATOMIC_RELEASE);
+    w->next_seq++;
+    if(JOURNAL_SYNC_POLICY != JOURNAL_SYNC_NONE && ++w->unsynced >= JOURNAL_SYNC_INTERVAL){
+        return journal_sync(w);
+    }
+    return 0;
+}
+
+static inline int journal_close(journal_writer *w){
+    if(w->base == NULL) return 0;
+    return journal_finish_segment(w, 1);
+}
+
+
+// --- Reader ---
+// Maps segments read-only on first use and keeps them until
+// journal_reader_close(), so pointers into older segments stay valid.
+typedef struct{
+    char path[256];
+    char *base[JOURNAL_MAX_SEGMENTS];
+} journal_reader;
+
+// -1 if `path` is too long for a journal.
+static inline int journal_reader_init(journal_reader *r, const char *path){
+    memset(r, 0, sizeof(*r));
+    return journal_set_path(r->path, sizeof(r->path), path);
+}
+
+// The segment's mapping, or NULL if it does not exist (yet).
+static inline char *journal_segment(journal_reader *r, uint32_t segment){
+    if(segment >= JOURNAL_MAX_SEGMENTS) return NULL;
+    if(r->base[segment]) return r->base[segment];
+
+    char name[sizeof(r->path) + 12];
+    if(journal_segment_path(name, sizeof(name), r->path, segment) == -1){
+        return NULL;
+    }
+    int fd = open(name, O_RDONLY);
+    if(fd == -1){
+        if(errno != ENOENT) perror("open(journal segment) failed.");
+        return NULL;
+    }
+    struct stat st;
+    if(fstat(fd, &st) == -1 || (uint64_t)st.st_size < JOURNAL_SEGMENT_BYTES){
+        close(fd);             // still being created
+        return NULL;
+    }
+    void *base = mmap(NULL, JOURNAL_SEGMENT_BYTES, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if(base == MAP_FAILED){
+        perror("mmap(journal segment) failed.");
+        return NULL;
+    }
+    if(__atomic_load_n(&((journal_segment_header *)base)->magic, __ATOMIC_ACQUIRE) != JOURNAL_MAGIC){
+        munmap(base, JOURNAL_SEGMENT_BYTES);
+        return NULL;
+    }
+    r->base[segment] = base;
+    return base;
+}
+
+static inline const char *journal_payload(journal_reader *r, journal_ref ref){
+    char *base = journal_segment(r, ref.segment);
+    return base ? base + ref.offset + sizeof(journal_record_header) : NULL;
+}
+
+static inline void journal_reader_close(journal_reader *r){
+    for(uint32_t segment = 0; segment < JOURNAL_MAX_SEGMENTS; segment++){
+        if(r->base[segment]) munmap(r->base[segment], JOURNAL_SEGMENT_BYTES);
+    }
+    memset(r->base, 0, sizeof(r->base));
+}
+
+// --- Replay cursor ---
+// Walks the log in sequence order from any starting point.
+typedef struct{
+    journal_reader *reader;
+    uint32_t segment;
+    uint64_t seq;                               // next record to return
+} journal_cursor;
+
+// Start at record `seq` (or at the first record if the log begins later).
+// -1 if there is no journal at all yet.
+static inline int journal_seek(journal_cursor *c, journal_reader *r, uint64_t seq){
+    c->reader = r;
+    c->segment = 0;
+    c->seq = seq;
+    return journal_segment(r, 0) ? 0 : -1;
+}
+
+enum { JOURNAL_RECORD = 1, JOURNAL_CAUGHT_UP = 0, JOURNAL_END = -1 };
+
+// JOURNAL_RECORD with *rec set, JOURNAL_CAUGHT_UP when the next record is
+// not committed yet, JOURNAL_END after the last record of a closed journal.
+static inline int journal_next(journal_cursor *c, const journal_record_header **rec){
+    for(;;){
+        char *base = journal_segment(c->reader, c->segment);
+        if(base == NULL) return JOURNAL_CAUGHT_UP;
+        journal_segment_header *hdr = (journal_segment_header *)base;
+        // flags before count: a record committed before the flag was set
+        // is then always seen.
+        int sealed = __atomic_load_n(&hdr->sealed, __ATOMIC_ACQUIRE);
+        int closed = __atomic_load_n(&hdr->closed, __ATOMIC_ACQUIRE);
+        uint64_t count = __atomic_load_n(&hdr->count, __ATOMIC_ACQUIRE);
+        if(c->seq < hdr->first_seq) c->seq = hdr->first_seq;
+        if(c->seq - hdr->first_seq < count){
+            *rec = (const journal_record_header *)(base + journal_index(base)[c->seq - hdr->first_seq]);
+            c->seq++;
+            return JOURNAL_RECORD;
+        }
+        if(closed) return JOURNAL_END;
+        if(!sealed) return JOURNAL_CAUGHT_UP;
+        c->segment++;
+    }
+}
+
+#endif
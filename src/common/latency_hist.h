@@ -0,0 +1,88 @@
+#ifndef LATENCY_HIST_H
+#define LATENCY_HIST_H
+
+// --- Latency histogram ---
+// Log-linear buckets (HDR-histogram style): values below 2^HIST_SUB_BITS ns
+// get one bucket each, every power of two above that is split into
+// 2^HIST_SUB_BITS buckets, so the relative error stays under ~3% from 1 ns
+// to ~18 minutes. Fixed size and pointer-free, so it can live inside a
+// shared-memory segment and be filled by one side and read by the other.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define HIST_SUB_BITS 5
+#define HIST_SUB_COUNT (1 << HIST_SUB_BITS)
+#define HIST_MAX_BITS 40
+#define HIST_BUCKETS ((HIST_MAX_BITS - HIST_SUB_BITS + 1) * HIST_SUB_COUNT)
+
+typedef struct {
+    uint64_t count;
+    uint64_t sum_ns;
+    uint64_t max_ns;
+    uint64_t buckets[HIST_BUCKETS];
+} latency_hist;
+
+static inline void hist_reset(latency_hist *hist){
+    memset(hist, 0, sizeof(*hist));
+}
+
+static inline int hist_bucket(uint64_t ns){
+    if(ns < HIST_SUB_COUNT) return (int)ns;
+    int msb = 63 - __builtin_clzll(ns);
+    if(msb >= HIST_MAX_BITS) return HIST_BUCKETS - 1;
+    int shift = msb - HIST_SUB_BITS;
+    // bucket group g = shift + 1 covers [2^msb, 2^(msb+1)).
+    return (shift + 1) * HIST_SUB_COUNT + (int)((ns >> shift) - HIST_SUB_COUNT);
+}
+
+// Lowest value that lands in `bucket`.
+static inline uint64_t hist_bucket_floor(int bucket){
+    if(bucket < HIST_SUB_COUNT) return (uint64_t)bucket;
+    int shift = bucket / HIST_SUB_COUNT - 1;
+    return (uint64_t)(bucket % HIST_SUB_COUNT + HIST_SUB_COUNT) << shift;
+}
+
+static inline void hist_record(latency_hist *hist, uint64_t ns){
+    hist->buckets[hist_bucket(ns)]++;
+    hist->count++;
+    hist->sum_ns += ns;
+    if(ns > hist->max_ns) hist->max_ns = ns;
+}
+
+static inline void hist_merge(latency_hist *into, const latency_hist *from){
+    for(int i = 0; i < HIST_BUCKETS; i++) into->buckets[i] += from->buckets[i];
+    into->count += from->count;
+    into->sum_ns += from->sum_ns;
+    if(from->max_ns > into->max_ns) into->max_ns = from->max_ns;
+}
+
+// Value at percentile p (0..100), reported as the floor of its bucket.
+static inline uint64_t hist_percentile(const latency_hist *hist, double p){
+    if(hist->count == 0) return 0;
+    uint64_t rank = (uint64_t)(p / 100.0 * (double)hist->count);
+    if(rank >= hist->count) rank = hist->count - 1;
+    uint64_t seen = 0;
+    for(int i = 0; i < HIST_BUCKETS; i++){
+        seen += hist->buckets[i];
+        if(seen > rank) return hist_bucket_floor(i);
+    }
+    return hist->max_ns;
+}
+
+static inline double hist_mean(const latency_hist *hist){
+    return hist->count ? (double)hist->sum_ns / (double)hist->count : 0.0;
+}
+
+// Append ",mean,p50,p90,p99,p99.9,max" (ns) to the current output line.
+static inline void hist_print_csv(const latency_hist *hist){
+    printf(",%.0f,%llu,%llu,%llu,%llu,%llu", hist_mean(hist),
+           (unsigned long long)hist_percentile(hist, 50.0),
+           (unsigned long long)hist_percentile(hist, 90.0),
+           (unsigned long long)hist_percentile(hist, 99.0),
+           (unsigned long long)hist_percentile(hist, 99.9),
+           (unsigned long long)hist->max_ns);
+}
+
+#endif
@@ -0,0 +1,24 @@
+#ifndef LAYOUT_H
+#define LAYOUT_H
+
+// --- Cache line layout ---
+// Default (packed) layout keeps the original field order, so the indices and
+// semaphores share cache lines and producer/consumer writes false-share.
+// -DPADDED_LAYOUT gives every hot field its own line (CACHE_ALIGNED) and
+// rounds each slot up to a whole number of lines (LAYOUT_SLOT_LEN). Use
+// -DCACHE_LINE_SIZE=128 on CPUs whose adjacent-line prefetcher pulls lines
+// in pairs.
+
+#ifndef CACHE_LINE_SIZE
+    #define CACHE_LINE_SIZE 64
+#endif
+
+#ifdef PADDED_LAYOUT
+    #define CACHE_ALIGNED __attribute__((aligned(CACHE_LINE_SIZE)))
+    #define LAYOUT_SLOT_LEN(bytes) (((bytes) + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE * CACHE_LINE_SIZE)
+#else
+    #define CACHE_ALIGNED
+    #define LAYOUT_SLOT_LEN(bytes) (bytes)
+#endif
+
+#endif
@@ -0,0 +1,174 @@
+#ifndef LIVE_STATS_H
+#define LIVE_STATS_H
+
+// --- Live stats segment ---
+// Build with -DLIVE_STATS and every channel publishes its counters into a
+// small shm segment, LIVE_STATS_PREFIX<channel>: messages, bytes and
+// blocks per side (occupancy is sent - received) and the consumer's
+// latency histogram. Each field has exactly one writer, which updates it
+// with a relaxed atomic store (no locked instruction, no fence), so the
+// cost on the hot path is a few plain stores to a line the side already
+// owns. Readers map the segment read-only and take snapshots whenever
+// they like; nothing they do can stall the channel. Without -DLIVE_STATS
+// every STATS_* macro expands to nothing.
+//
+// The producer creates the segment and unlinks it when it is done, the
+// consumer attaches to it; see monitor.c for the reader.
+
+#include <stdint.h>
+#include <string.h>
+#include "latency_hist.h"
+
+#define LIVE_STATS_PREFIX  "/ipc_stats."
+#define LIVE_STATS_MAGIC   0x5354415453435049ULL    // "IPCSTATS"
+#define LIVE_STATS_VERSION 1
+
+enum { STATS_PRODUCER, STATS_CONSUMER };
+
+typedef struct {
+    uint64_t messages;
+    uint64_t bytes;
+    uint64_t blocks;        // times the side had to sleep (ring full/empty, lock held)
+    int32_t pid;            // 0 until the side attaches
+} __attribute__((aligned(64))) stats_side;
+
+typedef struct {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t message_len;
+    uint32_t capacity;      // ring slots
+    char channel[64];
+    stats_side side[2];     // [STATS_PRODUCER], [STATS_CONSUMER]
+    latency_hist latency __attribute__((aligned(64)));   // consumer only
+} live_stats;
+
+// Relaxed snapshot of a segment another process is writing. The fields
+// are read one by one, so a snapshot can be a message or two inconsistent.
+static inline void stats_snapshot(const live_stats *stats, live_stats *copy){
+    copy->magic = stats->magic;
+    copy->version = stats->version;
+    copy->message_len = stats->message_len;
+    copy->capacity = stats->capacity;
+    memcpy(copy->channel, stats->channel, sizeof(copy->channel));
+    copy->channel[sizeof(copy->channel) - 1] = '\0';
+    // consumer first, so sent - received does not go negative.
+    for(int s = STATS_CONSUMER; s >= STATS_PRODUCER; s--){
+        copy->side[s].messages = __atomic_load_n(&stats->side[s].messages, __ATOMIC_RELAXED);
+        copy->side[s].bytes = __atomic_load_n(&stats->side[s].bytes, __ATOMIC_RELAXED);
+        copy->side[s].blocks = __atomic_load_n(&stats->side[s].blocks, __ATOMIC_RELAXED);
+        copy->side[s].pid = __atomic_load_n(&stats->side[s].pid, __ATOMIC_RELAXED);
+    }
+    copy->latency.count = 0;
+    for(int i = 0; i < HIST_BUCKETS; i++){
+        copy->latency.buckets[i] = __atomic_load_n(&stats->latency.buckets[i], __ATOMIC_RELAXED);
+        copy->latency.count += copy->latency.buckets[i];
+    }
+    copy->latency.sum_ns = __atomic_load_n(&stats->latency.sum_ns, __ATOMIC_RELAXED);
+    copy->latency.max_ns = __atomic_load_n(&stats->latency.max_ns, __ATOMIC_RELAXED);
+}
+
+#ifdef LIVE_STATS
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+typedef struct {
+    live_stats *stats;
+    int side;
+    char name[128];
+} stats_handle;
+
+static stats_handle stats_current;
+
+// Single-writer counter bump: a load and a store, both relaxed.
+static inline void stats_add(uint64_t *counter, uint64_t n){
+    __atomic_store_n(counter, __atomic_load_n(counter, __ATOMIC_RELAXED) + n, __ATOMIC_RELAXED);
+}
+
+// Map LIVE_STATS_PREFIX<channel> and reset the calling side's part of it.
+// Both sides create the segment if it is not there yet, so they can start
+// in any order; a leftover segment from a crashed run is simply reused.
+static inline int stats_open(const char *channel, int side, uint32_t message_len, uint32_t capacity){
+    snprintf(stats_current.name, sizeof(stats_current.name), "%s%s", LIVE_STATS_PREFIX, channel);
+    int fd = shm_open(stats_current.name, O_RDWR | O_CREAT, 0644);
+    if(fd == -1){
+        perror("stats_open: shm_open failed.");
+        return -1;
+    }
+    if(ftruncate(fd, sizeof(live_stats)) == -1){
+        perror("stats_open: ftruncate failed.");
+        close(fd);
+        return -1;
+    }
+    live_stats *stats = mmap(NULL, sizeof(live_stats), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if(stats == MAP_FAILED){
+        perror("stats_open: mmap failed.");
+        return -1;
+    }
+
+    // both sides write the same header values.
+    stats->version = LIVE_STATS_VERSION;
+    stats->message_len = message_len;
+    stats->capacity = capacity;
+    strncpy(stats->channel, channel, sizeof(stats->channel) - 1);
+    memset(&stats->side[side], 0, sizeof(stats_side));
+    if(side == STATS_CONSUMER) hist_reset(&stats->latency);
+    __atomic_store_n(&stats->side[side].pid, (int32_t)getpid(), __ATOMIC_RELAXED);
+    __atomic_store_n(&stats->magic, LIVE_STATS_MAGIC, __ATOMIC_RELEASE);
+
+    stats_current.stats = stats;
+    stats_current.side = side;
+    return 0;
+}
+
+static inline void stats_message(uint64_t bytes){
+    stats_side *s = &stats_current.stats->side[stats_current.side];
+    stats_add(&s->messages, 1);
+    stats_add(&s->bytes, bytes);
+}
+
+static inline void stats_block(void){
+    stats_add(&stats_current.stats->side[stats_current.side].blocks, 1);
+}
+
+static inline void stats_latency(uint64_t ns){
+    latency_hist *hist = &stats_current.stats->latency;
+    stats_add(&hist->buckets[hist_bucket(ns)], 1);
+    stats_add(&hist->count, 1);
+    stats_add(&hist->sum_ns, ns);
+    if(ns > hist->max_ns) __atomic_store_n(&hist->max_ns, ns, __ATOMIC_RELAXED);
+}
+
+// The producer takes the name away; readers that still have the segment
+// mapped see its final values.
+static inline void stats_close(void){
+    if(stats_current.stats == NULL) return;
+    if(stats_current.side == STATS_PRODUCER) shm_unlink(stats_current.name);
+    munmap(stats_current.stats, sizeof(live_stats));
+    stats_current.stats = NULL;
+}
+
+    #define STATS_OPEN(channel, side, len, capacity)  stats_open((channel), (side), (len), (capacity))
+    #define STATS_MESSAGE(bytes)                      stats_message(bytes)
+    #define STATS_BLOCK()                             stats_block()
+    #define STATS_LATENCY(ns)                         stats_latency(ns)
+    #define STATS_CLOSE()                             stats_close()
+#else
+static inline int stats_open_disabled(const char *channel, int side, uint32_t message_len, uint32_t capacity){
+    (void)channel;
+    (void)side;
+    (void)message_len;
+    (void)capacity;
+    return 0;
+}
+    #define STATS_OPEN(channel, side, len, capacity)  stats_open_disabled((channel), (side), (len), (capacity))
+    #define STATS_MESSAGE(bytes)
+    #define STATS_BLOCK()
+    #define STATS_LATENCY(ns)
+    #define STATS_CLOSE()
+#endif
+
+#endif
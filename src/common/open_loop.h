@@ -0,0 +1,90 @@
+#ifndef OPEN_LOOP_H
+#define OPEN_LOOP_H
+
+// --- Open-loop producer ---
+// With -DOPEN_LOOP the producer no longer sends as fast as `space` allows:
+// message i gets an intended send time from a fixed schedule at TARGET_RATE
+// messages/s (evenly spaced, or exponential gaps with -DPOISSON_ARRIVALS)
+// and is stamped with that time, not with the time it actually went out.
+// The consumer measures latency from the stamp, so time a message spends
+// waiting for space is counted instead of hidden (coordinated omission).
+// Poisson arrivals need -lm.
+
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#ifdef POISSON_ARRIVALS
+    #include <math.h>   // log
+#endif
+
+#ifndef TARGET_RATE
+    #define TARGET_RATE 100000          // offered load, messages per second
+#endif
+#ifndef OPEN_LOOP_SPIN_NS
+    #define OPEN_LOOP_SPIN_NS 20000     // spin instead of sleep for the last 20 us
+#endif
+
+#define SEND_STAMP_LEN sizeof(uint64_t)
+
+static inline uint64_t monotonic_ns(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+typedef struct {
+    uint64_t next_ns;       // intended send time of the next message
+    uint64_t rng;           // xorshift64 state for Poisson gaps
+    double gap_ns;          // mean gap between messages
+} open_loop_pacer;
+
+static inline void pacer_start(open_loop_pacer *pacer, uint64_t now_ns){
+    pacer->next_ns = now_ns;
+    pacer->rng = 0x9E3779B97F4A7C15ULL;
+    pacer->gap_ns = 1e9 / TARGET_RATE;
+}
+
+// Overrides TARGET_RATE for this pacer (messages per second, > 0).
+static inline void pacer_set_rate(open_loop_pacer *pacer, double rate){
+    pacer->gap_ns = 1e9 / rate;
+}
+
+// Sleep/spin until the intended time of the next message and return it.
+// A producer that is behind schedule returns at once, without skipping.
+static inline uint64_t pacer_wait(open_loop_pacer *pacer){
+    uint64_t target = pacer->next_ns;
+    for(;;){
+        uint64_t now = monotonic_ns();
+        if(now >= target) break;
+        if(target - now > OPEN_LOOP_SPIN_NS){
+            uint64_t wake = target - OPEN_LOOP_SPIN_NS;
+            struct timespec ts = { .tv_sec = (time_t)(wake / 1000000000ULL), .tv_nsec = (long)(wake % 1000000000ULL) };
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+        }
+    }
+
+#ifdef POISSON_ARRIVALS
+    pacer->rng ^= pacer->rng << 13;
+    pacer->rng ^= pacer->rng >> 7;
+    pacer->rng ^= pacer->rng << 17;
+    double u = ((pacer->rng >> 11) + 1.0) / 9007199254740993.0;     // (0, 1]
+    pacer->next_ns += (uint64_t)(-log(u) * pacer->gap_ns);
+#else
+    pacer->next_ns += (uint64_t)pacer->gap_ns;
+#endif
+    return target;
+}
+
+// The stamp goes in the last bytes of the message, so DEBUG's
+// "Product:%d" text at the front stays readable.
+static inline void write_send_stamp(char *message, size_t len, uint64_t ns){
+    memcpy(message + len - SEND_STAMP_LEN, &ns, SEND_STAMP_LEN);
+}
+
+static inline uint64_t read_send_stamp(const char *message, size_t len){
+    uint64_t ns;
+    memcpy(&ns, message + len - SEND_STAMP_LEN, SEND_STAMP_LEN);
+    return ns;
+}
+
+#endif
@@ -0,0 +1,132 @@
+#ifndef RENDEZVOUS_H
+#define RENDEZVOUS_H
+
+// --- Socket rendezvous ---
+// Two processes meet on an abstract UNIX socket named after a channel and
+// exchange file descriptors over it with SCM_RIGHTS. Whichever side comes
+// first binds the name and sleeps in accept(), the other one connects, so
+// nobody polls, and the name disappears with the socket (nothing to unlink
+// after a crash). Different channel names never collide.
+//
+// Needs _GNU_SOURCE (SOCK_CLOEXEC) in the includer.
+
+#include <errno.h>
+#include <sched.h>
+#include <stddef.h>    // offsetof
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#define RENDEZVOUS_PREFIX "posix-concurrency-lab."
+#define RENDEZVOUS_MAX_FDS 8
+
+static inline socklen_t rendezvous_address(struct sockaddr_un *addr, const char *channel){
+    memset(addr, 0, sizeof(*addr));
+    addr->sun_family = AF_UNIX;
+    // sun_path[0] == '\0': Linux abstract namespace.
+    int n = snprintf(addr->sun_path + 1, sizeof(addr->sun_path) - 1, "%s%s", RENDEZVOUS_PREFIX, channel);
+    if(n < 0 || (size_t)n >= sizeof(addr->sun_path) - 1) n = sizeof(addr->sun_path) - 2;
+    return (socklen_t)(offsetof(struct sockaddr_un, sun_path) + 1 + n);
+}
+
+// Return a socket connected to the peer on `channel`, or -1.
+static inline int rendezvous_connect(const char *channel){
+    struct sockaddr_un addr;
+    socklen_t addr_len = rendezvous_address(&addr, channel);
+
+    for(;;){
+        int sock = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if(sock == -1){
+            perror("rendezvous: socket failed.");
+            return -1;
+        }
+
+        if(bind(sock, (struct sockaddr *)&addr, addr_len) == 0){
+            // first one here: wait for the peer.
+            if(listen(sock, 1) == -1){
+                perror("rendezvous: listen failed.");
+                close(sock);
+                return -1;
+            }
+            int conn = accept4(sock, NULL, NULL, SOCK_CLOEXEC);
+            if(conn == -1) perror("rendezvous: accept failed.");
+            close(sock);
+            return conn;
+        }
+        if(errno != EADDRINUSE){
+            perror("rendezvous: bind failed.");
+            close(sock);
+            return -1;
+        }
+
+        if(connect(sock, (struct sockaddr *)&addr, addr_len) == 0) return sock;
+        close(sock);
+        // the peer is between bind() and listen(), or has just closed its
+        // listener; try again from the top.
+        if(errno != ECONNREFUSED){
+            perror("rendezvous: connect failed.");
+            return -1;
+        }
+        sched_yield();
+    }
+}
+
+// Send `nfds` descriptors plus `len` bytes of payload in one message.
+static inline int send_fds(int sock, const int *fds, int nfds, const void *data, size_t len){
+    char control[CMSG_SPACE(sizeof(int) * RENDEZVOUS_MAX_FDS)];
+    struct iovec iov = { .iov_base = (void *)data, .iov_len = len };
+    struct msghdr msg = { .msg_iov = &iov, .msg_iovlen = 1 };
+
+    if(nfds > RENDEZVOUS_MAX_FDS) nfds = RENDEZVOUS_MAX_FDS;
+    if(nfds > 0){
+        memset(control, 0, sizeof(control));
+        msg.msg_control = control;
+        msg.msg_controllen = CMSG_SPACE(sizeof(int) * nfds);
+        struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int) * nfds);
+        memcpy(CMSG_DATA(cmsg), fds, sizeof(int) * nfds);
+    }
+    if(sendmsg(sock, &msg, MSG_NOSIGNAL) == -1){
+        perror("rendezvous: sendmsg failed.");
+        return -1;
+    }
+    return 0;
+}
+
+// Blocks until the peer's message arrives. Returns the number of
+// descriptors received (at most max_fds), or -1.
+static inline int recv_fds(int sock, int *fds, int max_fds, void *data, size_t len){
+    char control[CMSG_SPACE(sizeof(int) * RENDEZVOUS_MAX_FDS)];
+    struct iovec iov = { .iov_base = data, .iov_len = len };
+    struct msghdr msg = { .msg_iov = &iov, .msg_iovlen = 1,
+                          .msg_control = control, .msg_controllen = sizeof(control) };
+
+    ssize_t n = recvmsg(sock, &msg, MSG_WAITALL | MSG_CMSG_CLOEXEC);
+    if(n == -1){
+        perror("rendezvous: recvmsg failed.");
+        return -1;
+    }
+    if((size_t)n != len){
+        fprintf(stderr, "rendezvous: peer closed the channel.\n");
+        return -1;
+    }
+
+    int count = 0;
+    for(struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg != NULL; cmsg = CMSG_NXTHDR(&msg, cmsg)){
+        if(cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS) continue;
+        int received = (int)((cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int));
+        for(int i = 0; i < received; i++){
+            int fd;
+            memcpy(&fd, CMSG_DATA(cmsg) + i * sizeof(int), sizeof(int));
+            if(count < max_fds) fds[count++] = fd;
+            else close(fd);
+        }
+    }
+    return count;
+}
+
+#endif
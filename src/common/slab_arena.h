@@ -0,0 +1,86 @@
+#ifndef SLAB_ARENA_H
+#define SLAB_ARENA_H
+
+// --- Slab arena ---
+// A size-class allocator that lives entirely inside a shared mapping.
+// Blocks are powers of two from 64 bytes up; each class has a lock-free
+// free list (Treiber stack, tagged head against ABA) threaded through the
+// free blocks themselves, and new blocks are carved from a bump region.
+//
+// Handles are offsets from the arena start (with the size class in the top
+// byte), so they mean the same thing in every process that maps the
+// arena, wherever it lands. 0 is never a valid handle.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define ARENA_MIN_SHIFT 6                       // 64-byte blocks
+#define ARENA_CLASSES   26                      // ... up to 2^31 bytes
+#define ARENA_NULL      0ULL
+#define ARENA_ALIGN     (1 << ARENA_MIN_SHIFT)
+
+typedef struct {
+    uint64_t size;                              // bytes, header included
+    uint64_t bump;                              // next uncarved offset
+    uint64_t free_head[ARENA_CLASSES];          // tag << 32 | (unit index + 1)
+} arena_header;
+
+#define ARENA_DATA_START (((sizeof(arena_header)) + ARENA_ALIGN - 1) / ARENA_ALIGN * ARENA_ALIGN)
+
+static inline void arena_init(arena_header *arena, size_t size){
+    memset(arena, 0, sizeof(*arena));
+    arena->size = size;
+    arena->bump = ARENA_DATA_START;
+}
+
+static inline int arena_class(size_t size){
+    int c = 0;
+    while(((size_t)1 << (c + ARENA_MIN_SHIFT)) < size) c++;
+    return c;
+}
+
+static inline void *arena_ptr(arena_header *arena, uint64_t handle){
+    return (char *)arena + (handle & 0x00FFFFFFFFFFFFFFULL);
+}
+
+// The first 4 bytes of a free block hold the next free block's unit index.
+static inline uint32_t *arena_link(arena_header *arena, uint64_t unit){
+    return (uint32_t *)((char *)arena + (unit - 1) * ARENA_ALIGN);
+}
+
+// Returns ARENA_NULL when the class's free list and the bump region are
+// both exhausted.
+static inline uint64_t arena_alloc(arena_header *arena, size_t size){
+    int c = arena_class(size);
+    if(c >= ARENA_CLASSES) return ARENA_NULL;
+    uint64_t block_size = (uint64_t)1 << (c + ARENA_MIN_SHIFT);
+
+    uint64_t head = __atomic_load_n(&arena->free_head[c], __ATOMIC_ACQUIRE);
+    while((uint32_t)head != 0){
+        uint64_t unit = (uint32_t)head;
+        uint32_t next = __atomic_load_n(arena_link(arena, unit), __ATOMIC_RELAXED);
+        uint64_t popped = ((head >> 32) + 1) << 32 | next;
+        if(__atomic_compare_exchange_n(&arena->free_head[c], &head, popped, 0, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)){
+            return (uint64_t)c << 56 | (unit - 1) * ARENA_ALIGN;
+        }
+    }
+
+    uint64_t offset = __atomic_fetch_add(&arena->bump, block_size, __ATOMIC_RELAXED);
+    if(offset + block_size > arena->size) return ARENA_NULL;
+    return (uint64_t)c << 56 | offset;
+}
+
+static inline void arena_free(arena_header *arena, uint64_t handle){
+    int c = (int)(handle >> 56);
+    uint64_t unit = (handle & 0x00FFFFFFFFFFFFFFULL) / ARENA_ALIGN + 1;
+
+    uint64_t head = __atomic_load_n(&arena->free_head[c], __ATOMIC_RELAXED);
+    uint64_t pushed;
+    do{
+        __atomic_store_n(arena_link(arena, unit), (uint32_t)head, __ATOMIC_RELAXED);
+        pushed = ((head >> 32) + 1) << 32 | unit;
+    }while(!__atomic_compare_exchange_n(&arena->free_head[c], &head, pushed, 0, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+}
+
+#endif
@@ -0,0 +1,88 @@
+#ifndef STREAM_COPY_H
+#define STREAM_COPY_H
+
+// --- Large message path ---
+// Messages of at least STREAM_COPY_THRESHOLD bytes are written with
+// non-temporal stores: the producer never reads a slot back, so a plain
+// memcpy only evicts its own working set. The consumer prefetches ahead in
+// the current slot and into the next one when it is already published.
+// Force either path with -DUSE_STREAM_COPY=0/1.
+//
+// The default depends on the message size, so include this after
+// MAX_MESSAGE_LEN is defined.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#if defined(__SSE2__)
+    #include <emmintrin.h> // _mm_stream_si128, _mm_sfence
+#endif
+#include "layout.h"        // CACHE_LINE_SIZE
+
+#ifndef MAX_MESSAGE_LEN
+    #error "define MAX_MESSAGE_LEN before including stream_copy.h"
+#endif
+
+#ifndef STREAM_COPY_THRESHOLD
+    #define STREAM_COPY_THRESHOLD 16384
+#endif
+#ifndef USE_STREAM_COPY
+    #if MAX_MESSAGE_LEN >= STREAM_COPY_THRESHOLD
+        #define USE_STREAM_COPY 1
+    #else
+        #define USE_STREAM_COPY 0
+    #endif
+#endif
+#ifndef PREFETCH_DISTANCE
+    #define PREFETCH_DISTANCE (8 * CACHE_LINE_SIZE)
+#endif
+
+// Copy a message into its slot. On the streaming path the stores bypass the
+// cache, so they are fenced here before the caller publishes the slot.
+static inline void write_message(char *slot, const char *src, size_t len){
+#if USE_STREAM_COPY && defined(__SSE2__)
+    size_t head = (16 - ((uintptr_t)slot & 15)) & 15;
+    if(head > len) head = len;
+    memcpy(slot, src, head);
+
+    size_t j = head;
+    for(; j + 64 <= len; j += 64){
+        __m128i a = _mm_loadu_si128((const __m128i *)(src + j));
+        __m128i b = _mm_loadu_si128((const __m128i *)(src + j + 16));
+        __m128i c = _mm_loadu_si128((const __m128i *)(src + j + 32));
+        __m128i d = _mm_loadu_si128((const __m128i *)(src + j + 48));
+        _mm_stream_si128((__m128i *)(slot + j), a);
+        _mm_stream_si128((__m128i *)(slot + j + 16), b);
+        _mm_stream_si128((__m128i *)(slot + j + 32), c);
+        _mm_stream_si128((__m128i *)(slot + j + 48), d);
+    }
+    for(; j + 16 <= len; j += 16){
+        _mm_stream_si128((__m128i *)(slot + j), _mm_loadu_si128((const __m128i *)(src + j)));
+    }
+    memcpy(slot + j, src + j, len - j);
+    _mm_sfence();
+#else
+    memcpy(slot, src, len);
+#endif
+}
+
+// Byte-sum of a slot. `next` is the following slot if it is already
+// published (NULL otherwise); on the streaming path its lines are prefetched
+// one per line of the current slot so they arrive before we get there.
+static inline uint64_t checksum_message(const char *slot, const char *next, size_t len){
+    (void)next;
+    uint64_t total_checksum = 0;
+    for(size_t line = 0; line < len; line += CACHE_LINE_SIZE){
+#if USE_STREAM_COPY
+        if(line + PREFETCH_DISTANCE < len) __builtin_prefetch(slot + line + PREFETCH_DISTANCE, 0, 3);
+        if(next) __builtin_prefetch(next + line, 0, 1);    // L2: read one slot later
+#endif
+        size_t end = line + CACHE_LINE_SIZE < len ? line + CACHE_LINE_SIZE : len;
+        for(size_t j = line; j < end; j++){
+            total_checksum += slot[j];
+        }
+    }
+    return total_checksum;
+}
+
+#endif
@@ -0,0 +1,208 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+// --- Event tracing ---
+// Build with -DTRACE to record enqueue/dequeue/block/wake events into a
+// per-thread ring of fixed-size binary records. The ring lives in an mmap'd
+// file, so it survives the process and costs one TSC read and one store per
+// event. Without -DTRACE every TRACE_* macro expands to nothing.
+//
+// Convert the files with scripts/trace_to_json.py and open the result in
+// chrome://tracing or https://ui.perfetto.dev.
+
+#include <stdint.h>
+
+enum {
+    TRACE_ENQUEUE = 1,      // producer published message `arg`
+    TRACE_DEQUEUE = 2,      // consumer took message `arg`
+    TRACE_BLOCK   = 3,      // caller is about to sleep on `resource`
+    TRACE_WAKE    = 4,      // caller woke up on `resource`
+};
+
+enum {
+    TRACE_RES_NONE    = 0,
+    TRACE_RES_LOCK    = 1,  // mutex / binary semaphore
+    TRACE_RES_SPACE   = 2,  // waiting for a free slot
+    TRACE_RES_PRODUCT = 3,  // waiting for a message
+};
+
+#ifdef TRACE
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+    #include <x86intrin.h> // __rdtsc
+#endif
+
+#ifndef TRACE_CAPACITY
+    #define TRACE_CAPACITY (1 << 20)    // records per thread (24 MB)
+#endif
+#ifndef TRACE_DIR
+    #define TRACE_DIR "."
+#endif
+
+#define TRACE_MAGIC   0x45434152544c4350ULL    // "PCLTRACE"
+#define TRACE_VERSION 1
+
+typedef struct {
+    uint64_t tsc;
+    uint64_t arg;           // message sequence number
+    uint32_t tid;
+    uint16_t event;
+    uint16_t resource;
+} trace_record;
+
+// The first page of every trace file. The two (tsc, CLOCK_MONOTONIC) pairs
+// taken at open and close let the converter put every thread and process
+// on one time axis.
+typedef struct {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t record_size;
+    uint64_t capacity;
+    uint64_t head;          // records written so far (ring index = head % capacity)
+    uint64_t start_tsc, start_ns;
+    uint64_t end_tsc, end_ns;
+    uint32_t pid, tid;
+    char name[32];
+} trace_header;
+
+#define TRACE_HEADER_SIZE 4096
+
+typedef struct {
+    trace_header *header;
+    trace_record *records;
+    size_t size;
+} trace_buffer;
+
+static __thread trace_buffer trace_current;
+
+static inline uint64_t trace_now(void){
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#endif
+}
+
+static inline uint64_t trace_monotonic_ns(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// Create TRACE_DIR/trace_<name>_<pid>_<tid>.bin for the calling thread.
+// syscall() needs _GNU_SOURCE (or the default feature set) in the includer.
+// Call it before the timed region: it maps and pre-faults the whole ring.
+static inline int trace_open(const char *name){
+    char path[256];
+    pid_t pid = getpid();
+    pid_t tid = (pid_t)syscall(SYS_gettid);
+    snprintf(path, sizeof(path), "%s/trace_%s_%d_%d.bin", TRACE_DIR, name, (int)pid, (int)tid);
+
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if(fd == -1){
+        perror("trace_open: open failed.");
+        return -1;
+    }
+    size_t size = TRACE_HEADER_SIZE + (size_t)TRACE_CAPACITY * sizeof(trace_record);
+    if(ftruncate(fd, size) == -1){
+        perror("trace_open: ftruncate failed.");
+        close(fd);
+        return -1;
+    }
+    void *buffer = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if(buffer == MAP_FAILED){
+        perror("trace_open: mmap failed.");
+        return -1;
+    }
+
+    // fault the whole ring in now rather than on the traced path.
+    for(size_t offset = 0; offset < size; offset += 4096){
+        ((volatile char *)buffer)[offset] = 0;
+    }
+
+    trace_header *header = (trace_header *)buffer;
+    header->magic = TRACE_MAGIC;
+    header->version = TRACE_VERSION;
+    header->record_size = sizeof(trace_record);
+    header->capacity = TRACE_CAPACITY;
+    header->head = 0;
+    header->pid = (uint32_t)pid;
+    header->tid = (uint32_t)tid;
+    strncpy(header->name, name, sizeof(header->name) - 1);
+    header->start_ns = trace_monotonic_ns();
+    header->start_tsc = trace_now();
+
+    trace_current.header = header;
+    trace_current.records = (trace_record *)((char *)buffer + TRACE_HEADER_SIZE);
+    trace_current.size = size;
+    return 0;
+}
+
+static inline void trace_event(uint16_t event, uint16_t resource, uint64_t arg){
+    trace_header *header = trace_current.header;
+    if(header == NULL) return;
+    uint64_t head = header->head;
+    trace_record *record = &trace_current.records[head % TRACE_CAPACITY];
+    record->tsc = trace_now();
+    record->arg = arg;
+    record->tid = header->tid;
+    record->event = event;
+    record->resource = resource;
+    header->head = head + 1;
+}
+
+// Move the calling thread's ring to another thread: open it where the
+// setup cost is not timed, TRACE_DETACH() it, and TRACE_ATTACH() it in the
+// thread that records. Events then carry the attaching thread's tid.
+typedef trace_buffer trace_handle;
+
+static inline trace_handle trace_detach(void){
+    trace_handle handle = trace_current;
+    memset(&trace_current, 0, sizeof(trace_current));
+    return handle;
+}
+
+static inline void trace_attach(trace_handle handle){
+    trace_current = handle;
+    if(handle.header) handle.header->tid = (uint32_t)syscall(SYS_gettid);
+}
+
+static inline void trace_close(void){
+    trace_header *header = trace_current.header;
+    if(header == NULL) return;
+    header->end_tsc = trace_now();
+    header->end_ns = trace_monotonic_ns();
+    munmap(header, trace_current.size);
+    trace_current.header = NULL;
+}
+
+    #define TRACE_OPEN(name)                   trace_open(name)
+    #define TRACE_DETACH()                     trace_detach()
+    #define TRACE_ATTACH(handle)               trace_attach(handle)
+    #define TRACE_EVENT(event, resource, arg)  trace_event((event), (resource), (uint64_t)(arg))
+    #define TRACE_CLOSE()                      trace_close()
+#else
+typedef struct { char unused; } trace_handle;
+
+static inline int trace_open_disabled(const char *name){
+    (void)name;
+    return 0;
+}
+    #define TRACE_OPEN(name)                   trace_open_disabled(name)
+    #define TRACE_DETACH()                     ((trace_handle){ 0 })
+    #define TRACE_ATTACH(handle)               ((void)(handle))
+    #define TRACE_EVENT(event, resource, arg)
+    #define TRACE_CLOSE()
+#endif
+
+#endif
@@ -0,0 +1,259 @@
+#ifndef WORKLOAD_H
+#define WORKLOAD_H
+
+// --- Per-message workloads ---
+// The work each side does per message is picked at run time, so one binary
+// can sweep the compute-to-communication ratio:
+//
+//   WORKLOAD=<name>           consumer, default "checksum"
+//   PRODUCER_WORKLOAD=<name>  producer, default "none"
+//
+// where <name> is one of
+//   none        no work
+//   checksum    byte-sum (the original consumer work)
+//   crc32c      CRC32C, SSE4.2 crc32 instruction when the CPU has it
+//   xxhash      XXH64
+//   parse       validate printable text, split on ':'/',' and parse numbers
+//   spin:<ns>   calibrated busy loop of <ns> nanoseconds, independent of
+//               the message length
+//
+// Adding a workload is one function and one workload_table[] entry.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#if defined(__x86_64__)
+    #include <nmmintrin.h> // _mm_crc32_u64, _mm_crc32_u8
+#endif
+
+typedef struct workload workload;
+typedef uint64_t (*workload_fn)(const workload *work, const char *message, size_t len);
+
+struct workload {
+    const char *name;
+    workload_fn run;
+    uint64_t spin_ns;           // spin: requested duration
+    uint64_t spin_iters;        // spin: calibrated loop count
+};
+
+
+static uint64_t workload_none(const workload *work, const char *message, size_t len){
+    (void)work;
+    (void)message;
+    (void)len;
+    return 0;
+}
+
+static uint64_t workload_checksum(const workload *work, const char *message, size_t len){
+    (void)work;
+    uint64_t total_checksum = 0;
+    for(size_t j = 0; j < len; j++){
+        total_checksum += message[j];
+    }
+    return total_checksum;
+}
+
+
+// CRC32C (Castagnoli), reflected polynomial 0x82F63B78.
+static uint64_t crc32c_soft(const char *message, size_t len){
+    uint32_t crc = 0xFFFFFFFFu;
+    for(size_t i = 0; i < len; i++){
+        crc ^= (uint8_t)message[i];
+        for(int k = 0; k < 8; k++){
+            crc = (crc >> 1) ^ (0x82F63B78u & -(crc & 1u));
+        }
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+#if defined(__x86_64__)
+__attribute__((target("sse4.2")))
+static uint64_t crc32c_sse42(const char *message, size_t len){
+    uint64_t crc = 0xFFFFFFFFu;
+    size_t i = 0;
+    for(; i + 8 <= len; i += 8){
+        uint64_t word;
+        memcpy(&word, message + i, sizeof(word));
+        crc = _mm_crc32_u64(crc, word);
+    }
+    for(; i < len; i++){
+        crc = _mm_crc32_u8((uint32_t)crc, (uint8_t)message[i]);
+    }
+    return (uint32_t)crc ^ 0xFFFFFFFFu;
+}
+#endif
+
+static uint64_t workload_crc32c(const workload *work, const char *message, size_t len){
+    (void)work;
+#if defined(__x86_64__)
+    if(__builtin_cpu_supports("sse4.2")) return crc32c_sse42(message, len);
+#endif
+    return crc32c_soft(message, len);
+}
+
+
+// XXH64 with seed 0.
+#define XXH_P1 11400714785074694791ULL
+#define XXH_P2 14029467366897019727ULL
+#define XXH_P3 1609587929392839161ULL
+#define XXH_P4 9650029242287828579ULL
+#define XXH_P5 2870177450012600261ULL
+
+static inline uint64_t xxh_rotl(uint64_t x, int r){
+    return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t xxh_read64(const char *p){
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint64_t xxh_round(uint64_t acc, uint64_t input){
+    acc += input * XXH_P2;
+    return xxh_rotl(acc, 31) * XXH_P1;
+}
+
+static inline uint64_t xxh_merge(uint64_t acc, uint64_t val){
+    acc ^= xxh_round(0, val);
+    return acc * XXH_P1 + XXH_P4;
+}
+
+static uint64_t workload_xxhash(const workload *work, const char *message, size_t len){
+    (void)work;
+    const char *p = message;
+    const char *end = message + len;
+    uint64_t h;
+
+    if(len >= 32){
+        uint64_t v1 = XXH_P1 + XXH_P2, v2 = XXH_P2, v3 = 0, v4 = -XXH_P1;
+        for(; p + 32 <= end; p += 32){
+            v1 = xxh_round(v1, xxh_read64(p));
+            v2 = xxh_round(v2, xxh_read64(p + 8));
+            v3 = xxh_round(v3, xxh_read64(p + 16));
+            v4 = xxh_round(v4, xxh_read64(p + 24));
+        }
+        h = xxh_rotl(v1, 1) + xxh_rotl(v2, 7) + xxh_rotl(v3, 12) + xxh_rotl(v4, 18);
+        h = xxh_merge(h, v1);
+        h = xxh_merge(h, v2);
+        h = xxh_merge(h, v3);
+        h = xxh_merge(h, v4);
+    }else{
+        h = XXH_P5;
+    }
+    h += len;
+
+    for(; p + 8 <= end; p += 8){
+        h ^= xxh_round(0, xxh_read64(p));
+        h = xxh_rotl(h, 27) * XXH_P1 + XXH_P4;
+    }
+    if(p + 4 <= end){
+        uint32_t v;
+        memcpy(&v, p, sizeof(v));
+        h ^= (uint64_t)v * XXH_P1;
+        h = xxh_rotl(h, 23) * XXH_P2 + XXH_P3;
+        p += 4;
+    }
+    for(; p < end; p++){
+        h ^= (uint8_t)*p * XXH_P5;
+        h = xxh_rotl(h, 11) * XXH_P1;
+    }
+
+    h ^= h >> 33;
+    h *= XXH_P2;
+    h ^= h >> 29;
+    h *= XXH_P3;
+    h ^= h >> 32;
+    return h;
+}
+
+
+// A text-protocol style pass: stop at NUL, reject non-printable bytes, count
+// ':'/',' separated fields and parse every run of digits. Returns
+// fields | numbers-sum << 16 with the high bit set if validation failed.
+static uint64_t workload_parse(const workload *work, const char *message, size_t len){
+    (void)work;
+    uint64_t fields = 1, sum = 0, number = 0, invalid = 0;
+    for(size_t i = 0; i < len && message[i] != '\0'; i++){
+        unsigned char c = (unsigned char)message[i];
+        if(c >= '0' && c <= '9'){
+            number = number * 10 + (c - '0');
+            continue;
+        }
+        sum += number;
+        number = 0;
+        if(c == ':' || c == ','){
+            fields++;
+        }else if(c < 0x20 || c > 0x7e){
+            invalid = 1;
+        }
+    }
+    sum += number;
+    return fields | (sum << 16) | (invalid << 63);
+}
+
+
+static inline void spin_loop(uint64_t iters){
+    for(uint64_t i = 0; i < iters; i++){
+        __asm__ volatile("" ::: "memory");
+    }
+}
+
+static uint64_t workload_spin(const workload *work, const char *message, size_t len){
+    (void)message;
+    (void)len;
+    spin_loop(work->spin_iters);
+    return work->spin_iters;
+}
+
+// Loop iterations per ns, best of a few runs so a preemption does not
+// inflate the estimate.
+static inline double spin_calibrate(void){
+    const uint64_t iters = 1 << 22;
+    double best = 0;
+    for(int r = 0; r < 5; r++){
+        struct timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        spin_loop(iters);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        double ns = (end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec);
+        if(ns > 0 && iters / ns > best) best = iters / ns;
+    }
+    return best;
+}
+
+
+static const workload workload_table[] = {
+    { "none",     workload_none,     0, 0 },
+    { "checksum", workload_checksum, 0, 0 },
+    { "crc32c",   workload_crc32c,   0, 0 },
+    { "xxhash",   workload_xxhash,   0, 0 },
+    { "parse",    workload_parse,    0, 0 },
+    { "spin",     workload_spin,     0, 0 },
+};
+
+// Fill *work from environment variable `env` (or `fallback` if unset).
+// Call it before the timed region: "spin" calibrates here.
+static inline int workload_from_env(workload *work, const char *env, const char *fallback){
+    const char *spec = getenv(env);
+    if(spec == NULL || *spec == '\0') spec = fallback;
+
+    size_t name_len = strcspn(spec, ":");
+    for(size_t i = 0; i < sizeof(workload_table) / sizeof(workload_table[0]); i++){
+        const workload *entry = &workload_table[i];
+        if(strlen(entry->name) != name_len || strncmp(entry->name, spec, name_len) != 0) continue;
+
+        *work = *entry;
+        if(entry->run == workload_spin){
+            work->spin_ns = spec[name_len] == ':' ? strtoull(spec + name_len + 1, NULL, 10) : 1000;
+            work->spin_iters = (uint64_t)(work->spin_ns * spin_calibrate());
+        }
+        return 0;
+    }
+    fprintf(stderr, "%s: unknown workload \"%s\" (none, checksum, crc32c, xxhash, parse, spin:<ns>)\n", env, spec);
+    return -1;
+}
+
+#endif